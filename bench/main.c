@@ -0,0 +1,1046 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dbll.h>
+
+#define ARRAY_SIZE(_array) \
+	(sizeof(_array) / sizeof((_array)[0]))
+
+typedef void (*bench_func_f)();
+
+// same idea as test_func_t, nicer names for functions
+typedef struct {
+	bench_func_f bench;
+	const char *name;
+} bench_func_t;
+
+#define BENCH_FUNC(_name) \
+	{ \
+		_name, \
+		#_name \
+	}
+
+// how deep the benchmark tree is, it has 2^depth - 1 lists
+#define BENCH_TREE_DEPTH 22
+#define BENCH_WALK_COUNT 1000000
+
+static double bench_now() {
+	struct timespec now = { 0 };
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + (now.tv_nsec / 1e9);
+}
+
+// makes a full binary tree of the given depth out of blocks from
+// next_ptr on, children before their parent. returns its root
+static dbll_ptr_t bench_tree_fill(
+	dbll_state_t *state, 
+	int depth, 
+	dbll_ptr_t *next_ptr
+) {
+	if(depth <= 0) {
+		return DBLL_NULL;
+	}
+
+	dbll_list_t list = { 0 };
+	list.head_ptr = bench_tree_fill(state, depth - 1, next_ptr);
+	list.tail_ptr = bench_tree_fill(state, depth - 1, next_ptr);
+	list.this_ptr = *next_ptr;
+	(*next_ptr)++;
+	if(dbll_list_write(&list, state) < 0) {
+		return DBLL_NULL;
+	}
+
+	return list.this_ptr;
+}
+
+// the whole tree is one run of blocks, so the file only grows once
+static dbll_ptr_t bench_tree_make(dbll_state_t *state, int depth) {
+	dbll_ptr_t count = ((dbll_ptr_t)(1) << depth) - 1;
+	dbll_ptr_t *ptrs = malloc(count * sizeof(dbll_ptr_t));
+	if(
+		ptrs == NULL ||
+		dbll_state_alloc_n(
+			state, 
+			count, 
+			ptrs, 
+			DBLL_ALLOC_CONTIGUOUS
+		) < 0
+	) {
+		free(ptrs);
+		return DBLL_NULL;
+	}
+
+	dbll_ptr_t next_ptr = ptrs[0];
+	free(ptrs);
+	return bench_tree_fill(state, depth, &next_ptr);
+}
+
+// makes the benchmark tree file once, every benchmark
+// after that loads it however it wants
+static dbll_ptr_t bench_tree_root = DBLL_NULL;
+static const char *bench_tree_path = "db/bench-tree.dbll";
+static int bench_tree_file() {
+	if(bench_tree_root != DBLL_NULL) {
+		return 0;
+	}
+
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, bench_tree_path) < 0) {
+		return -1;
+	}
+
+	dbll_state_sync_policy(&state, DBLL_SYNC_NONE);
+	bench_tree_root = bench_tree_make(&state, BENCH_TREE_DEPTH);
+
+	// hung off the root list so everything can be reached from it
+	state.root_list.head_ptr = bench_tree_root;
+	dbll_list_write(&state.root_list, &state);
+	dbll_state_unload(&state);
+	return bench_tree_root == DBLL_NULL
+		? -1
+		: 0;
+}
+
+typedef int (*bench_go_f)(dbll_list_t *, dbll_state_t *, list_go_e);
+
+// random walks from the root down depth levels with go, returns
+// how many lists were gone through per second
+static double bench_walk(dbll_state_t *state, bench_go_f go, int depth) {
+	srand(1);
+	dbll_list_t list = { 0 };
+	double start = bench_now();
+	long step_count = 0;
+	for(int i = 0; i < BENCH_WALK_COUNT / depth; i++) {
+		if(dbll_list_load(&list, state, bench_tree_root) < 0) {
+			return 0;
+		}
+
+		for(int level = 1; level < depth; level++) {
+			if(
+				go(
+					&list,
+					state,
+					rand() & 1
+						? DBLL_GO_HEAD
+						: DBLL_GO_TAIL
+				) < 0
+			) {
+				return 0;
+			}
+
+			step_count++;
+		}
+	}
+
+	return step_count / (bench_now() - start);
+}
+
+// random walks from the root down to a leaf
+static double bench_tree_walk(dbll_state_t *state) {
+	return bench_walk(state, dbll_list_go, BENCH_TREE_DEPTH);
+}
+
+void bench_hugepage() {
+	if(bench_tree_file() < 0) {
+		printf("couldn't make the tree file\n");
+		return;
+	}
+
+	const int flags[] = {
+		DBLL_OPEN_STABLE,
+		DBLL_OPEN_HUGEPAGE
+	};
+
+	const char *flag_names[] = {
+		"DBLL_OPEN_STABLE",
+		"DBLL_OPEN_HUGEPAGE"
+	};
+
+	for(int i = 0; i < ARRAY_SIZE(flags); i++) {
+		dbll_state_t state = { 0 };
+		if(dbll_state_load_flags(&state, bench_tree_path, flags[i]) < 0) {
+			printf("couldn't load the tree file\n");
+			return;
+		}
+
+		// first walk faults everything in, the second
+		// one is the one that gets measured
+		bench_tree_walk(&state);
+		printf(
+			"%s: %.0f random list_go/s\n",
+			flag_names[i],
+			bench_tree_walk(&state)
+		);
+
+		dbll_state_unload(&state);
+	}
+}
+
+// how many fields the field benchmarks go through, over the first
+// BENCH_FIELD_BLOCKS blocks so it's the decoding that gets measured
+// and not cache misses
+#define BENCH_FIELD_COUNT 20000000
+#define BENCH_FIELD_BLOCKS 4096
+
+// nanoseconds per field read and written, written fields
+// get the value they already had
+static void bench_field_cost(dbll_state_t *state, const char *name) {
+	dbll_index_t index = dbll_ptr_to_index(state, 2);
+	dbll_index_t end = dbll_ptr_to_index(state, BENCH_FIELD_BLOCKS);
+	int ptr_size = state->header.ptr_size;
+	dbll_ptr_t sum = 0;
+	double start = bench_now();
+	for(long i = 0; i < BENCH_FIELD_COUNT; i++) {
+		dbll_ptr_t ptr = 0;
+		dbll_index_ptr_copy(state, index, &ptr);
+		sum += ptr;
+		index += ptr_size;
+		if(index >= end) {
+			index = dbll_ptr_to_index(state, 2);
+		}
+	}
+
+	double read_time = bench_now() - start;
+	index = dbll_ptr_to_index(state, 2);
+	start = bench_now();
+	for(long i = 0; i < BENCH_FIELD_COUNT; i++) {
+		dbll_ptr_t ptr = 0;
+		dbll_index_ptr_copy(state, index, &ptr);
+		dbll_ptr_index_copy(state, ptr, index);
+		index += ptr_size;
+		if(index >= end) {
+			index = dbll_ptr_to_index(state, 2);
+		}
+	}
+
+	double write_time = bench_now() - start - read_time;
+	printf(
+		"%s: %.2f ns per field read, %.2f ns per field write (%llu)\n",
+		name,
+		read_time * 1e9 / BENCH_FIELD_COUNT,
+		write_time * 1e9 / BENCH_FIELD_COUNT,
+		(unsigned long long)(sum % 10)
+	);
+}
+
+void bench_native() {
+	if(bench_tree_file() < 0) {
+		printf("couldn't make the tree file\n");
+		return;
+	}
+
+	dbll_state_t state = { 0 };
+	if(dbll_state_load(&state, bench_tree_path) < 0) {
+		printf("couldn't load the tree file\n");
+		return;
+	}
+
+	dbll_state_sync_policy(&state, DBLL_SYNC_NONE);
+	bench_field_cost(&state, "DBLL_FORMAT_DEFAULT");
+	bench_tree_walk(&state);
+	printf(
+		"DBLL_FORMAT_DEFAULT: %.0f random list_go/s\n",
+		bench_tree_walk(&state)
+	);
+
+	double start = bench_now();
+	if(dbll_state_convert(&state, DBLL_FORMAT_NATIVE) < 0) {
+		printf("couldn't convert the tree file\n");
+		dbll_state_unload(&state);
+		return;
+	}
+
+	printf("converting took %.2f s\n", bench_now() - start);
+	bench_field_cost(&state, "DBLL_FORMAT_NATIVE");
+	bench_tree_walk(&state);
+	printf(
+		"DBLL_FORMAT_NATIVE: %.0f random list_go/s\n",
+		bench_tree_walk(&state)
+	);
+
+	// the other benchmarks expect the tree the way it was made
+	dbll_state_convert(&state, DBLL_FORMAT_DEFAULT);
+	dbll_state_unload(&state);
+}
+
+// the blocks are the same size either way with the default sizes, so
+// the only thing that changes is that the header gets padded and none
+// of the lists straddle a cache line anymore
+void bench_aligned() {
+	if(bench_tree_file() < 0) {
+		printf("couldn't make the tree file\n");
+		return;
+	}
+
+	dbll_state_t state = { 0 };
+	if(dbll_state_load(&state, bench_tree_path) < 0) {
+		printf("couldn't load the tree file\n");
+		return;
+	}
+
+	dbll_state_sync_policy(&state, DBLL_SYNC_NONE);
+	dbll_index_t block_bytes = (
+		state.header.block_count * 
+		state.header.list_size
+	);
+
+	bench_tree_walk(&state);
+	printf(
+		"unaligned: %.0f random list_go/s\n",
+		bench_tree_walk(&state)
+	);
+
+	if(dbll_state_convert(&state, DBLL_FORMAT_ALIGNED) < 0) {
+		printf("couldn't convert the tree file\n");
+		dbll_state_unload(&state);
+		return;
+	}
+
+	bench_tree_walk(&state);
+	printf(
+		"DBLL_FORMAT_ALIGNED: %.0f random list_go/s\n",
+		bench_tree_walk(&state)
+	);
+
+	dbll_index_t aligned_bytes = (
+		state.header.header_size +
+		state.header.block_count * state.header.block_size
+	);
+
+	printf(
+		"%ld bytes of lists take %ld bytes aligned, %.2f%% overhead\n",
+		(long)(block_bytes),
+		(long)(aligned_bytes),
+		(aligned_bytes - block_bytes) * 100.0 / block_bytes
+	);
+
+	// the same with 8 byte pointers, which is where the padding costs
+	int sizes[] = { 4, 8 };
+	for(int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		int list_size = sizes[i] * 3 + 4;
+		int block_size = 1;
+		while(block_size < list_size) {
+			block_size *= 2;
+		}
+
+		printf(
+			"%d byte pointers: %d byte lists in %d byte blocks, "
+			"%.2f%% overhead\n",
+			sizes[i],
+			list_size,
+			block_size,
+			(block_size - list_size) * 100.0 / list_size
+		);
+	}
+
+	dbll_state_convert(&state, DBLL_FORMAT_DEFAULT);
+	dbll_state_unload(&state);
+}
+
+// the top of the tree fits in the cache, so walking just that
+// shows what checking the state every step costs
+#define BENCH_HOT_DEPTH 12
+
+void bench_unchecked() {
+	if(bench_tree_file() < 0) {
+		printf("couldn't make the tree file\n");
+		return;
+	}
+
+	dbll_state_t state = { 0 };
+	if(dbll_state_load(&state, bench_tree_path) < 0) {
+		printf("couldn't load the tree file\n");
+		return;
+	}
+
+	const bench_go_f gos[] = {
+		dbll_list_go,
+		dbll_list_go_unchecked
+	};
+
+	const char *go_names[] = {
+		"dbll_list_go",
+		"dbll_list_go_unchecked"
+	};
+
+	for(int i = 0; i < ARRAY_SIZE(gos); i++) {
+		bench_walk(&state, gos[i], BENCH_TREE_DEPTH);
+		printf(
+			"%s: %.0f random list_go/s, %.0f in the top %d levels\n",
+			go_names[i],
+			bench_walk(&state, gos[i], BENCH_TREE_DEPTH),
+			bench_walk(&state, gos[i], BENCH_HOT_DEPTH),
+			BENCH_HOT_DEPTH
+		);
+	}
+
+	dbll_state_unload(&state);
+}
+
+// the same walk as bench_walk with a cursor
+static double bench_cursor_walk(dbll_state_t *state, int depth) {
+	srand(1);
+	dbll_cursor_t cursor = { 0 };
+	double start = bench_now();
+	long step_count = 0;
+	for(int i = 0; i < BENCH_WALK_COUNT / depth; i++) {
+		if(dbll_cursor_load(&cursor, state, bench_tree_root, NULL, 0) < 0) {
+			return 0;
+		}
+
+		for(int level = 1; level < depth; level++) {
+			int result = rand() & 1
+				? dbll_cursor_head(&cursor)
+				: dbll_cursor_tail(&cursor);
+
+			if(result < 0) {
+				return 0;
+			}
+
+			step_count++;
+		}
+	}
+
+	return step_count / (bench_now() - start);
+}
+
+void bench_cursor() {
+	if(bench_tree_file() < 0) {
+		printf("couldn't make the tree file\n");
+		return;
+	}
+
+	dbll_state_t state = { 0 };
+	if(dbll_state_load(&state, bench_tree_path) < 0) {
+		printf("couldn't load the tree file\n");
+		return;
+	}
+
+	bench_cursor_walk(&state, BENCH_TREE_DEPTH);
+	printf(
+		"dbll_cursor_t: %.0f random moves/s, %.0f in the top %d levels\n",
+		bench_cursor_walk(&state, BENCH_TREE_DEPTH),
+		bench_cursor_walk(&state, BENCH_HOT_DEPTH),
+		BENCH_HOT_DEPTH
+	);
+
+	dbll_state_unload(&state);
+}
+
+// how many blocks the data benchmark's chain is
+#define BENCH_DATA_BLOCKS 1000000
+
+// what dbll_data_slot_read_mem and write_mem used to do, a read
+// or a write for every byte
+static int bench_byte_copy(
+	dbll_state_t *state,
+	dbll_data_slot_t *slot,
+	uint8_t *mem,
+	dbll_index_t mem_size,
+	int is_write
+) {
+	int page_size = state->header.data_slot_size;
+	dbll_data_slot_t page = *slot;
+	dbll_index_t page_offset = 0;
+	for(dbll_index_t i = 0; i < mem_size; i++) {
+		if(page_offset >= page_size) {
+			page_offset = 0;
+			if(dbll_data_slot_next(&page, state) < 0) {
+				return -1;
+			}
+		}
+
+		dbll_index_t index = page.data_index + page_offset;
+		int result = is_write
+			? dbll_state_dirty(state, index, 1) < 0 ||
+				dbll_file_write(&state->file, index, &mem[i], 1) < 0
+			: dbll_file_read(&state->file, index, &mem[i], 1) < 0;
+
+		if(result) {
+			return -1;
+		}
+
+		page_offset++;
+	}
+
+	return 0;
+}
+
+void bench_data_copy() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/bench-data.dbll") < 0) {
+		printf("couldn't make the data file\n");
+		return;
+	}
+
+	dbll_state_sync_policy(&state, DBLL_SYNC_NONE);
+	dbll_data_slot_t slot = { 0 };
+	dbll_index_t size = (
+		(dbll_index_t)(BENCH_DATA_BLOCKS) * 
+		state.header.data_slot_size
+	);
+
+	uint8_t *mem = malloc(size);
+	if(
+		mem == NULL ||
+		dbll_list_data_resize(
+			&state.root_list, 
+			&state, 
+			BENCH_DATA_BLOCKS
+		) < 0 ||
+
+		dbll_data_slot_load(&slot, &state, state.root_list.data_ptr) < 0
+	) {
+		printf("couldn't make the data chain\n");
+		free(mem);
+		dbll_state_unload(&state);
+		return;
+	}
+
+	for(dbll_index_t i = 0; i < size; i++) {
+		mem[i] = i;
+	}
+
+	for(int is_write = 1; is_write >= 0; is_write--) {
+		double start = bench_now();
+		int result = bench_byte_copy(&state, &slot, mem, size, is_write);
+		double byte_time = bench_now() - start;
+		start = bench_now();
+		result |= is_write
+			? dbll_data_slot_write_mem(&slot, &state, 0, mem, size)
+			: dbll_data_slot_read_mem(&slot, &state, 0, mem, size);
+
+		double span_time = bench_now() - start;
+		if(result < 0) {
+			printf("couldn't copy the data\n");
+			break;
+		}
+
+		printf(
+			"%s: %.0f MB/s a byte at a time, %.0f MB/s a block at a time\n",
+			is_write
+				? "dbll_data_slot_write_mem"
+				: "dbll_data_slot_read_mem",
+			size / byte_time / 1e6,
+			size / span_time / 1e6
+		);
+	}
+
+	free(mem);
+	dbll_state_unload(&state);
+}
+
+// reads a byte at random offsets of the chain bench_data_copy made,
+// returns how many reads a second
+static double bench_random_read(
+	dbll_state_t *state, 
+	dbll_data_slot_t *slot,
+	long count
+) {
+	srand(1);
+	dbll_index_t size = (
+		(dbll_index_t)(BENCH_DATA_BLOCKS) * 
+		state->header.data_slot_size
+	);
+
+	double start = bench_now();
+	for(long i = 0; i < count; i++) {
+		uint8_t byte = 0;
+		dbll_index_t offset = (
+			((dbll_index_t)(rand()) << 16 ^ rand()) % 
+			size
+		);
+
+		if(dbll_data_slot_read_mem(slot, state, offset, &byte, 1) < 0) {
+			return 0;
+		}
+	}
+
+	return count / (bench_now() - start);
+}
+
+void bench_page_table() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_load(&state, "db/bench-data.dbll") < 0) {
+		printf("couldn't load the data file\n");
+		return;
+	}
+
+	dbll_data_slot_t slot = { 0 };
+	dbll_page_table_t table = { 0 };
+	if(dbll_data_slot_load(&slot, &state, state.root_list.data_ptr) < 0) {
+		printf("couldn't load the data chain\n");
+		dbll_state_unload(&state);
+		return;
+	}
+
+	printf(
+		"without a page table: %.0f random reads/s\n",
+		bench_random_read(&state, &slot, 200)
+	);
+
+	// reading the last byte fills the whole table in
+	uint8_t byte = 0;
+	dbll_index_t size = (
+		(dbll_index_t)(BENCH_DATA_BLOCKS) * 
+		state.header.data_slot_size
+	);
+
+	dbll_page_table_load(&table, &slot);
+	double start = bench_now();
+	dbll_data_slot_read_mem(&slot, &state, size - 1, &byte, 1);
+	double fill_time = bench_now() - start;
+	printf(
+		"with a page table: %.0f random reads/s, filling it took %.3f s\n",
+		bench_random_read(&state, &slot, 1000000),
+		fill_time
+	);
+
+	dbll_page_table_unload(&table);
+	dbll_state_unload(&state);
+}
+
+// appends 8 bytes at a time, with the list's last block forgotten
+// every time when is_cold, which is walking the chain every time
+// like growing it used to. returns appends a second
+static double bench_append_run(long count, int is_cold) {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/bench-append.dbll") < 0) {
+		return 0;
+	}
+
+	dbll_state_sync_policy(&state, DBLL_SYNC_NONE);
+	uint8_t mem[8] = { 0 };
+	double start = bench_now();
+	for(long i = 0; i < count; i++) {
+		if(is_cold) {
+			state.root_list.data_tail_ptr = DBLL_NULL;
+		}
+
+		if(
+			dbll_list_data_append(
+				&state.root_list, 
+				&state, 
+				mem, 
+				sizeof(mem)
+			) < 0
+		) {
+			dbll_state_unload(&state);
+			return 0;
+		}
+	}
+
+	double time = bench_now() - start;
+	dbll_state_unload(&state);
+	return count / time;
+}
+
+void bench_append() {
+	const long counts[] = { 10000, 40000 };
+	for(int i = 0; i < ARRAY_SIZE(counts); i++) {
+		printf(
+			"%ld appends: %.0f appends/s walking the chain, %.0f cached\n",
+			counts[i],
+			bench_append_run(counts[i], 1),
+			bench_append_run(counts[i], 0)
+		);
+	}
+
+	printf(
+		"1000000 appends: %.0f appends/s cached\n",
+		bench_append_run(1000000, 0)
+	);
+}
+
+// how many spans go to writev at a time
+#define BENCH_IOV_COUNT 1024
+
+// sends the chain bench_data_copy made to /dev/null, once copied out
+// with dbll_data_slot_read_mem and once straight from the mapping
+void bench_data_iov() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_load(&state, "db/bench-data.dbll") < 0) {
+		printf("couldn't load the data file\n");
+		return;
+	}
+
+	dbll_data_slot_t slot = { 0 };
+	int desc = open("/dev/null", O_WRONLY);
+	dbll_index_t size = state.root_list.data_size;
+	uint8_t *mem = malloc(size);
+	if(
+		desc < 0 ||
+		mem == NULL ||
+		dbll_data_slot_load(&slot, &state, state.root_list.data_ptr) < 0
+	) {
+		printf("couldn't load the data chain\n");
+		free(mem);
+		dbll_state_unload(&state);
+		return;
+	}
+
+	// a page table so both of them only go through the chain once
+	dbll_page_table_t table = { 0 };
+	dbll_page_table_load(&table, &slot);
+	dbll_data_slot_read_mem(&slot, &state, size - 1, mem, 1);
+
+	double start = bench_now();
+	dbll_data_slot_read_mem(&slot, &state, 0, mem, size);
+	write(desc, mem, size);
+	double copy_time = bench_now() - start;
+
+	struct iovec iovs[BENCH_IOV_COUNT] = { 0 };
+	start = bench_now();
+	for(dbll_index_t offset = 0; offset < size;) {
+		int count = dbll_data_slot_iov(
+			&slot,
+			&state,
+			offset,
+			size - offset,
+			iovs,
+			BENCH_IOV_COUNT
+		);
+
+		if(count <= 0) {
+			printf("couldn't get the spans\n");
+			break;
+		}
+
+		for(int i = 0; i < count; i++) {
+			offset += iovs[i].iov_len;
+		}
+
+		writev(desc, iovs, count);
+	}
+
+	double iov_time = bench_now() - start;
+	printf(
+		"%ld bytes to /dev/null: %.0f MB/s copied out, %.0f MB/s with iovs\n",
+		(long)(size),
+		size / copy_time / 1e6,
+		size / iov_time / 1e6
+	);
+
+	close(desc);
+	free(mem);
+	dbll_page_table_unload(&table);
+	dbll_state_unload(&state);
+}
+
+#define BENCH_BLOB_SIZE (1 << 20)
+#define BENCH_BLOB_READS 20
+
+// reads the list's data all the way through a few times, returns
+// how long a read takes on average
+static double bench_blob_read(
+	dbll_state_t *state, 
+	dbll_list_t *list, 
+	uint8_t *mem
+) {
+	double start = bench_now();
+	for(int i = 0; i < BENCH_BLOB_READS; i++) {
+		dbll_list_data_read(list, state, 0, mem, BENCH_BLOB_SIZE);
+	}
+
+	return (bench_now() - start) / BENCH_BLOB_READS;
+}
+
+// the same blob as a chain and as an extent, how many blocks
+// each one takes and how fast it reads back
+void bench_extent() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/bench-extent.dbll") < 0) {
+		printf("couldn't make the extent file\n");
+		return;
+	}
+
+	dbll_list_t chain = { 0 };
+	dbll_list_t extent = { 0 };
+	chain.this_ptr = dbll_state_alloc(&state);
+	extent.this_ptr = dbll_state_alloc(&state);
+	uint8_t *mem = malloc(BENCH_BLOB_SIZE);
+	if(mem == NULL) {
+		printf("couldn't make the blob\n");
+		dbll_state_unload(&state);
+		return;
+	}
+
+	memset(mem, 0x5a, BENCH_BLOB_SIZE);
+	dbll_ptr_t block_count = state.header.block_count;
+	if(
+		dbll_list_write(&chain, &state) < 0 ||
+		dbll_list_data_append(&chain, &state, mem, BENCH_BLOB_SIZE) < 0
+	) {
+		printf("couldn't make the chain\n");
+		free(mem);
+		dbll_state_unload(&state);
+		return;
+	}
+
+	dbll_ptr_t chain_blocks = state.header.block_count - block_count;
+	block_count = state.header.block_count;
+	if(
+		dbll_list_write(&extent, &state) < 0 ||
+		dbll_list_data_alloc_extent(&extent, &state, BENCH_BLOB_SIZE) < 0 ||
+		dbll_list_data_write(&extent, &state, 0, mem, BENCH_BLOB_SIZE) < 0
+	) {
+		printf("couldn't make the extent\n");
+		free(mem);
+		dbll_state_unload(&state);
+		return;
+	}
+
+	dbll_ptr_t extent_blocks = state.header.block_count - block_count;
+	double chain_time = bench_blob_read(&state, &chain, mem);
+	double extent_time = bench_blob_read(&state, &extent, mem);
+	printf(
+		"%d byte blob: chain %lu blocks %.0f MB/s, "
+		"extent %lu blocks %.0f MB/s\n",
+		BENCH_BLOB_SIZE,
+		(unsigned long)(chain_blocks),
+		BENCH_BLOB_SIZE / chain_time / 1e6,
+		(unsigned long)(extent_blocks),
+		BENCH_BLOB_SIZE / extent_time / 1e6
+	);
+
+	free(mem);
+	dbll_state_unload(&state);
+}
+
+#define BENCH_VALUE_COUNT 20000
+#define BENCH_VALUE_MAX 512
+
+// makes a list for every value, then reads them all back. the sizes
+// are all over the place, the same ones every time
+static void bench_values(const char *name, int is_class) {
+	dbll_state_t state = { 0 };
+	dbll_list_t *lists = calloc(BENCH_VALUE_COUNT, sizeof(dbll_list_t));
+	uint8_t mem[BENCH_VALUE_MAX] = { 0 };
+	if(
+		lists == NULL ||
+		dbll_state_make_replace(&state, "db/bench-class.dbll") < 0
+	) {
+		printf("couldn't make the values file\n");
+		free(lists);
+		return;
+	}
+
+	srand(1);
+	dbll_ptr_t block_count = state.header.block_count;
+	double start = bench_now();
+	for(int i = 0; i < BENCH_VALUE_COUNT; i++) {
+		dbll_index_t size = rand() % BENCH_VALUE_MAX + 1;
+		lists[i].this_ptr = dbll_state_alloc(&state);
+		if(
+			dbll_list_write(&lists[i], &state) < 0 ||
+			(
+				!is_class &&
+				dbll_list_data_append(&lists[i], &state, mem, size) < 0
+			) || (
+				is_class && (
+					dbll_list_data_alloc_bytes(&lists[i], &state, size) < 0 ||
+					dbll_list_data_write(&lists[i], &state, 0, mem, size) < 0
+				)
+			)
+		) {
+			printf("couldn't make the values\n");
+			free(lists);
+			dbll_state_unload(&state);
+			return;
+		}
+	}
+
+	double write_time = bench_now() - start;
+	dbll_index_t total_size = 0;
+	start = bench_now();
+	for(int i = 0; i < BENCH_VALUE_COUNT; i++) {
+		dbll_list_data_read(&lists[i], &state, 0, mem, lists[i].data_size);
+		total_size += lists[i].data_size;
+	}
+
+	double read_time = bench_now() - start;
+	printf(
+		"%s: %ld bytes in %lu blocks (%.0f%% data), "
+		"%.0f values/s made, %.0f MB/s read\n",
+		name,
+		(long)(total_size),
+		(unsigned long)(state.header.block_count - block_count),
+		100.0 * total_size / (
+			(state.header.block_count - block_count) * 
+			state.header.block_size
+		),
+		BENCH_VALUE_COUNT / write_time,
+		total_size / read_time / 1e6
+	);
+
+	free(lists);
+	dbll_state_unload(&state);
+}
+
+void bench_class() {
+	bench_values("chains", 0);
+	bench_values("size classes", 1);
+}
+
+#define BENCH_COUNTER_COUNT 1000000
+
+// a counter in every list, then random lists loaded and their counter
+// read. appending to a list without data always makes a chain
+static void bench_counters(const char *name, int is_inline) {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/bench-inline.dbll") < 0) {
+		printf("couldn't make the counters file\n");
+		return;
+	}
+
+	uint8_t counter[4] = { 0 };
+	dbll_ptr_t first_ptr = DBLL_NULL;
+	for(int i = 0; i < BENCH_COUNTER_COUNT; i++) {
+		dbll_list_t list = { 0 };
+		list.this_ptr = dbll_state_alloc(&state);
+		if(first_ptr == DBLL_NULL) {
+			first_ptr = list.this_ptr;
+		}
+
+		if(
+			dbll_list_write(&list, &state) < 0 ||
+			(
+				is_inline && (
+					dbll_list_data_alloc_bytes(&list, &state, 4) < 0 ||
+					dbll_list_data_write(&list, &state, 0, counter, 4) < 0
+				)
+			) || (
+				!is_inline &&
+				dbll_list_data_append(&list, &state, counter, 4) < 0
+			)
+		) {
+			printf("couldn't make the counters\n");
+			dbll_state_unload(&state);
+			return;
+		}
+	}
+
+	srand(1);
+	double start = bench_now();
+	for(int i = 0; i < BENCH_COUNTER_COUNT; i++) {
+		dbll_list_t list = { 0 };
+		dbll_list_load(
+			&list, 
+			&state, 
+			first_ptr + (rand() % BENCH_COUNTER_COUNT) * (is_inline ? 1 : 2)
+		);
+
+		dbll_list_data_read(&list, &state, 0, counter, 4);
+	}
+
+	double time = bench_now() - start;
+	printf(
+		"%s: %.0f random counter reads/s\n", 
+		name, 
+		BENCH_COUNTER_COUNT / time
+	);
+	dbll_state_unload(&state);
+}
+
+void bench_inline() {
+	bench_counters("chain block", 0);
+	bench_counters("inline", 1);
+}
+
+#define BENCH_ALLOC_COUNT 1000000
+
+// frees every other block of a file with BENCH_ALLOC_COUNT of them,
+// then times getting BENCH_ALLOC_COUNT blocks back one at a time or
+// all at once. half come off the empty slot list, half are new
+static void bench_alloc_run(const char *name, int is_batch) {
+	dbll_state_t state = { 0 };
+	dbll_ptr_t *ptrs = malloc(BENCH_ALLOC_COUNT * sizeof(dbll_ptr_t));
+	if(
+		ptrs == NULL ||
+		dbll_state_make_replace(&state, "db/bench-alloc.dbll") < 0 ||
+		dbll_state_alloc_n(&state, BENCH_ALLOC_COUNT, ptrs, 0) < 0
+	) {
+		printf("couldn't make the alloc file\n");
+		free(ptrs);
+		return;
+	}
+
+	dbll_state_sync_policy(&state, DBLL_SYNC_NONE);
+	for(int i = 0; i < BENCH_ALLOC_COUNT; i += 2) {
+		dbll_state_mark_free(&state, ptrs[i]);
+	}
+
+	double start = bench_now();
+	if(is_batch) {
+		dbll_state_alloc_n(&state, BENCH_ALLOC_COUNT, ptrs, 0);
+	} else {
+		for(int i = 0; i < BENCH_ALLOC_COUNT; i++) {
+			ptrs[i] = dbll_state_alloc(&state);
+		}
+	}
+
+	double time = bench_now() - start;
+	printf(
+		"%s: %.0f blocks/s\n", 
+		name, 
+		BENCH_ALLOC_COUNT / time
+	);
+
+	free(ptrs);
+	dbll_state_unload(&state);
+}
+
+void bench_alloc_n() {
+	bench_alloc_run("dbll_state_alloc", 0);
+	bench_alloc_run("dbll_state_alloc_n", 1);
+
+	// a chain is made out of batches now
+	dbll_state_t state = { 0 };
+	dbll_data_slot_t slot = { 0 };
+	if(
+		dbll_state_make_replace(&state, "db/bench-alloc.dbll") < 0 ||
+		dbll_data_slot_load(&slot, &state, dbll_state_alloc(&state)) < 0
+	) {
+		printf("couldn't make the chain\n");
+		return;
+	}
+
+	dbll_state_sync_policy(&state, DBLL_SYNC_NONE);
+	double start = bench_now();
+	dbll_data_slot_alloc(&slot, &state, BENCH_ALLOC_COUNT);
+	double time = bench_now() - start;
+	printf(
+		"dbll_data_slot_alloc: %.0f blocks/s\n", 
+		BENCH_ALLOC_COUNT / time
+	);
+
+	dbll_state_unload(&state);
+}
+
+const bench_func_t dbll_bench_funcs[] = {
+	BENCH_FUNC(bench_hugepage),
+	BENCH_FUNC(bench_native),
+	BENCH_FUNC(bench_aligned),
+	BENCH_FUNC(bench_unchecked),
+	BENCH_FUNC(bench_cursor),
+	BENCH_FUNC(bench_data_copy),
+	BENCH_FUNC(bench_page_table),
+	BENCH_FUNC(bench_append),
+	BENCH_FUNC(bench_data_iov),
+	BENCH_FUNC(bench_extent),
+	BENCH_FUNC(bench_class),
+	BENCH_FUNC(bench_inline),
+	BENCH_FUNC(bench_alloc_n)
+};
+
+int main() {
+	for(int i = 0; i < ARRAY_SIZE(dbll_bench_funcs); i++) {
+		printf("running \"%s\"\n", dbll_bench_funcs[i].name);
+		dbll_bench_funcs[i].bench();
+	}
+
+	return 0;
+}
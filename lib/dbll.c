@@ -1,11 +1,16 @@
+#define _GNU_SOURCE
 #include "debug.h"
 #include <dbll.h>
 #include <fcntl.h>
 #include <string.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
+#include <endian.h>
+#include <linux/io_uring.h>
 
 // because we are debugging, only use DBLL_ERR for
 // "return DBLL_ERR;" because it's not intended for anything otherwise.
@@ -62,7 +67,19 @@
 	#define DBLL_NULL_ERR null_log(__LINE__)
 #endif
 
-static size_t file_size(int desc) {
+// read only states can't change file memory
+static int state_writable(dbll_state_t *state) {
+	return !(state->file.flags & DBLL_OPEN_READONLY);
+}
+
+// mappings are only writable if the file was opened that way
+static int file_prot(dbll_file_t *file) {
+	return file->flags & DBLL_OPEN_READONLY
+		? PROT_READ
+		: PROT_READ | PROT_WRITE;
+}
+
+static dbll_index_t file_size(int desc) {
 	struct stat file_stat = { 0 };
 	if(fstat(desc, &file_stat) < 0) {
 		return DBLL_ERR;
@@ -74,499 +91,3358 @@ static size_t file_size(int desc) {
 int dbll_file_valid(dbll_file_t *file) {
 	return (
 		DBLL_VALID(file != NULL) &&
-		DBLL_VALID(file->mem != NULL) && 
+		DBLL_VALID(
+			file->mem != NULL || 
+			file->pool.frames != NULL
+		) && 
+
 		DBLL_VALID(file->size > 0) &&
 		DBLL_VALID(file->desc > 0)
 	);
 }
 
-int dbll_file_load(dbll_file_t *file, const char *path) {
-	if(file == NULL || path == NULL) {
-		return DBLL_ERR;
+static void ring_unload(dbll_ring_t *ring) {
+	if(ring->sqes != NULL) {
+		munmap(ring->sqes, ring->sqes_size);
 	}
 
-	file->desc = open(path, O_RDWR | O_APPEND);
-	if(file->desc < 0) {
-		return DBLL_ERR;
+	if(ring->cq_mem != NULL && ring->cq_mem != ring->sq_mem) {
+		munmap(ring->cq_mem, ring->cq_size);
 	}
 
-	file->size = file_size(file->desc);
-	if(file->size < 0) {
-		dbll_file_unload(file);
-		return DBLL_ERR;
+	if(ring->sq_mem != NULL) {
+		munmap(ring->sq_mem, ring->sq_size);
 	}
 
-	file->mem = (uint8_t*)(
-		mmap(
-			NULL,
-			file->size,
-			PROT_READ | PROT_WRITE,
-			MAP_SHARED,
-			file->desc,
-			0
-		)
+	if(ring->desc >= 0) {
+		close(ring->desc);
+	}
+
+	*ring = (dbll_ring_t) { 0 };
+	ring->desc = -1;
+}
+
+static uint8_t *ring_map(int desc, size_t size, off_t offset) {
+	uint8_t *mem = mmap(
+		NULL,
+		size,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE,
+		desc,
+		offset
 	);
 
-	if(file->mem == (uint8_t *)(-1)) {
-		return DBLL_ERR;
+	if(mem == MAP_FAILED) {
+		return NULL;
 	}
 
-	return DBLL_OK;
+	return mem;
 }
 
-int dbll_file_unload(dbll_file_t *file) {
-	if(file == NULL) {
+// there's no liburing, so the ring is set up with the raw syscalls.
+// not having io_uring isn't an error, the pool just uses pread
+static int ring_load(dbll_ring_t *ring, unsigned entry_count) {
+	*ring = (dbll_ring_t) { 0 };
+	struct io_uring_params params = { 0 };
+	ring->desc = syscall(__NR_io_uring_setup, entry_count, &params);
+	if(ring->desc < 0) {
+		ring->desc = -1;
 		return DBLL_ERR;
 	}
 
-	if(
-		file->mem != NULL &&
-		msync(
-			file->mem, 
-			file->size, 
-			MS_SYNC
-		) < 0 &&
-		
-		munmap(file->mem, file->size) < 0
-	) {
-		return DBLL_ERR;
+	ring->entry_count = params.sq_entries;
+	ring->sq_size = (
+		params.sq_off.array + 
+		params.sq_entries * sizeof(unsigned)
+	);
+
+	ring->cq_size = (
+		params.cq_off.cqes + 
+		params.cq_entries * sizeof(struct io_uring_cqe)
+	);
+
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	// newer kernels map both rings in one go
+	int is_single = params.features & IORING_FEAT_SINGLE_MMAP;
+	if(is_single && ring->cq_size > ring->sq_size) {
+		ring->sq_size = ring->cq_size;
 	}
 
+	ring->sq_mem = ring_map(ring->desc, ring->sq_size, IORING_OFF_SQ_RING);
+	ring->cq_mem = is_single
+		? ring->sq_mem
+		: ring_map(ring->desc, ring->cq_size, IORING_OFF_CQ_RING);
+
+	ring->sqes = ring_map(ring->desc, ring->sqes_size, IORING_OFF_SQES);
 	if(
-		file->desc > 0 &&
-		close(file->desc) < 0
+		ring->sq_mem == NULL ||
+		ring->cq_mem == NULL ||
+		ring->sqes == NULL
 	) {
+		ring_unload(ring);
 		return DBLL_ERR;
 	}
 
-	file->mem = NULL;
-	file->size = 0;
-	file->desc = 0;
+	ring->sq_head = (unsigned *)(ring->sq_mem + params.sq_off.head);
+	ring->sq_tail = (unsigned *)(ring->sq_mem + params.sq_off.tail);
+	ring->sq_mask = (unsigned *)(ring->sq_mem + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned *)(ring->sq_mem + params.sq_off.array);
+	ring->cq_head = (unsigned *)(ring->cq_mem + params.cq_off.head);
+	ring->cq_tail = (unsigned *)(ring->cq_mem + params.cq_off.tail);
+	ring->cq_mask = (unsigned *)(ring->cq_mem + params.cq_off.ring_mask);
+	ring->cqes = ring->cq_mem + params.cq_off.cqes;
 	return DBLL_OK;
 }
 
-static const uint8_t file_boilerplate[] = {
+// reads size bytes at each offset into each buffer with one submission,
+// results gets what each read returned. count can't be more than
+// entry_count
+static int ring_read(
+	dbll_ring_t *ring,
+	int desc,
+	uint8_t **buffers,
+	const dbll_index_t *offsets,
+	int *results,
+	int count,
+	unsigned size
+) {
+	unsigned tail = *ring->sq_tail;
+	unsigned mask = *ring->sq_mask;
+	struct io_uring_sqe *sqes = (struct io_uring_sqe *)(ring->sqes);
+	for(int i = 0; i < count; i++) {
+		unsigned sqe_index = tail & mask;
+		struct io_uring_sqe *sqe = &sqes[sqe_index];
+		memset(sqe, 0, sizeof(*sqe));
+		sqe->opcode = IORING_OP_READ;
+		sqe->fd = desc;
+		sqe->addr = (uint64_t)(uintptr_t)(buffers[i]);
+		sqe->len = size;
+		sqe->off = offsets[i];
+		sqe->user_data = i;
+		ring->sq_array[sqe_index] = sqe_index;
+		tail++;
+	}
+
+	__atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+
+	int submit_count = 0;
+	int done_count = 0;
+	while(done_count < count) {
+		unsigned head = *ring->cq_head;
+		unsigned cq_tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+		if(head != cq_tail) {
+			struct io_uring_cqe *cqe = (struct io_uring_cqe *)(
+				ring->cqes + 
+				(head & *ring->cq_mask) * sizeof(struct io_uring_cqe)
+			);
 
-	// header
-	'd', 'b', 'l', 'l', 
-	4, 
-	4, 
-	0, 0, 0, 0,
+			if(cqe->user_data < (uint64_t)(count)) {
+				results[cqe->user_data] = cqe->res;
+			}
 
-	// empty root list
-	0, 0, 0, 0, 
-	0, 0, 0, 0, 
-	0, 0, 0, 0, 
-	0, 0, 0, 0
-};
+			__atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+			done_count++;
+			continue;
+		}
 
-int dbll_file_make(dbll_file_t *file, const char *path) {
-	if(file == NULL || path == NULL) {
-		return DBLL_ERR;
-	}
-	
-	// can't make already existing file
-	if(access(path, F_OK) >= 0) {
-		return DBLL_ERR;
-	}
-	
-	int desc = open(path, O_RDWR | O_CREAT);
-	if(desc < 0) {
-		return DBLL_ERR;
-	}
-	
-	if(
-		write(
-			desc, 
-			file_boilerplate, 
-			sizeof(file_boilerplate)
-		) < 0
-	) {
+		int result = syscall(
+			__NR_io_uring_enter,
+			ring->desc,
+			count - submit_count,
+			1,
+			IORING_ENTER_GETEVENTS,
+			NULL,
+			0
+		);
 
-		// don't care for errors on this close
-		// because something screwed up anyway
-		close(desc);
-		return DBLL_ERR;
-	}
-	
-	if(close(desc) < 0) {
-		return DBLL_ERR;
-	}
-	
-	if(
-		dbll_file_load(
-			file,
-			path
-		) < 0
-	) {
-		return DBLL_ERR;
+		if(result < 0) {
+			return DBLL_ERR;
+		}
+
+		submit_count += result;
 	}
 
 	return DBLL_OK;
 }
 
-int dbll_file_resize(dbll_file_t *file, int size) {
-	if(
-		!dbll_file_valid(file) ||
-		file->size + size < 0
-	) {
-		return DBLL_ERR;
+static int pool_load(dbll_pool_t *pool, int frame_count) {
+	pool->ring.desc = -1;
+	pool->frame_count = frame_count;
+	pool->bucket_count = 1;
+	while(pool->bucket_count < frame_count) {
+		pool->bucket_count *= 2;
 	}
 
-	msync(file->mem, file->size, MS_SYNC);
-	munmap(file->mem, file->size);
+	pool->hand = 0;
+	pool->mem = malloc((size_t)(frame_count) * DBLL_POOL_PAGE_SIZE);
+	pool->frames = malloc(frame_count * sizeof(dbll_pool_frame_t));
+	pool->buckets = malloc(pool->bucket_count * sizeof(int));
 	if(
-		ftruncate(
-			file->desc, 
-			file->size + size
-		) < 0
+		pool->mem == NULL ||
+		pool->frames == NULL ||
+		pool->buckets == NULL
 	) {
 		return DBLL_ERR;
 	}
-	
-	file->size += size;
-	file->mem = (uint8_t*)(
-		mmap(
-			NULL,
-			file->size,
-			PROT_READ | PROT_WRITE,
-			MAP_SHARED,
-			file->desc,
-			0
-		)
-	);
 
-	if(file->mem == (uint8_t *)(-1)) {
-		return DBLL_ERR;
+	for(int i = 0; i < frame_count; i++) {
+		pool->frames[i] = (dbll_pool_frame_t) { 0 };
+		pool->frames[i].page = -1;
+		pool->frames[i].next = -1;
+	}
+
+	for(int i = 0; i < pool->bucket_count; i++) {
+		pool->buckets[i] = -1;
 	}
 
+	ring_load(&pool->ring, DBLL_RING_ENTRIES);
 	return DBLL_OK;
 }
 
-// the magic number spells out "dbll" but in decimal form
-static const uint32_t dbll_header_magic = 1819042404;
-int dbll_header_valid(dbll_header_t *header) {
-	uint32_t magic_int = *((uint32_t *)(header->magic));
-	return (
-		DBLL_VALID(header != NULL) &&
-		DBLL_VALID(magic_int == dbll_header_magic) && DBLL_VALID(
-			header->ptr_size == 1 ||
-			header->ptr_size == 2 ||
-			header->ptr_size == 4 ||
-			header->ptr_size == 8
-		) &&
+static void pool_unload(dbll_pool_t *pool) {
+	ring_unload(&pool->ring);
+	free(pool->mem);
+	free(pool->frames);
+	free(pool->buckets);
+	*pool = (dbll_pool_t) { 0 };
+}
 
-		DBLL_VALID(header->data_size > 0) &&
-		DBLL_VALID(header->data_size <= DBLL_SIZE_MAX) &&
-		DBLL_VALID(header->list_size > 0) &&
-		DBLL_VALID(header->header_size > 0)
-	);
+static int *pool_bucket(dbll_pool_t *pool, dbll_index_t page) {
+	return &pool->buckets[page & (pool->bucket_count - 1)];
 }
 
-int dbll_header_load(dbll_header_t *header, dbll_file_t *file) {
-	if(!dbll_file_valid(file) || header == NULL) {
-		return DBLL_ERR;
+static int pool_find(dbll_pool_t *pool, dbll_index_t page) {
+	int frame = *pool_bucket(pool, page);
+	while(frame >= 0 && pool->frames[frame].page != page) {
+		frame = pool->frames[frame].next;
 	}
 
-	memcpy(header->magic, &file->mem[0], DBLL_MAGIC_SIZE);
-	header->ptr_size = file->mem[DBLL_MAGIC_SIZE];
-	header->data_size = file->mem[DBLL_MAGIC_SIZE + 1];
-
-	// done manually and not with memcpy in order to enforce endianness
-	int index = DBLL_MAGIC_SIZE + 2 + header->ptr_size;
-	header->empty_slot_ptr = 0;
-	for(int i = 0; i < header->ptr_size && index >= 0; i++) {
-		header->empty_slot_ptr |= (
-			(file->mem[index] << (i * 8)) &
-			(0xff << (i * 8))
-		);
+	return frame;
+}
 
-		index--;
+// takes a frame out of its bucket, the page in it is forgotten
+static void pool_forget(dbll_pool_t *pool, int frame) {
+	dbll_pool_frame_t *pool_frame = &pool->frames[frame];
+	int *link = pool_bucket(pool, pool_frame->page);
+	while(*link != frame) {
+		link = &pool->frames[*link].next;
 	}
 
-	// 3 because that's how many pointers are in dbll_list_t
-	// and empty_slot_size
-	header->header_size = DBLL_MAGIC_SIZE + 2 + header->ptr_size;
-	header->list_size = (header->ptr_size * 3) + header->data_size;
-	header->empty_slot_size = (header->ptr_size * 3) + 1;
-	header->data_slot_size = header->list_size - header->ptr_size;
-	return DBLL_OK;
+	*link = pool_frame->next;
+	pool_frame->page = -1;
+	pool_frame->next = -1;
+	pool_frame->is_dirty = 0;
+	pool_frame->is_used = 0;
 }
 
-int dbll_header_unload(dbll_header_t *header) {
-	if(!dbll_header_valid(header)) {
-		return DBLL_ERR;
+// only writes the part of the page that is in the file, the rest
+// of it would make the file bigger
+static int pool_write_back(dbll_file_t *file, int frame) {
+	dbll_pool_t *pool = &file->pool;
+	dbll_pool_frame_t *pool_frame = &pool->frames[frame];
+	dbll_index_t index = pool_frame->page * DBLL_POOL_PAGE_SIZE;
+	dbll_index_t size = (dbll_index_t)(file->size) - index;
+	if(size > DBLL_POOL_PAGE_SIZE) {
+		size = DBLL_POOL_PAGE_SIZE;
+	}
+
+	uint8_t *mem = pool->mem + (size_t)(frame) * DBLL_POOL_PAGE_SIZE;
+	while(size > 0) {
+		ssize_t written = pwrite(file->desc, mem, size, index);
+		if(written <= 0) {
+			return DBLL_ERR;
+		}
+
+		mem += written;
+		index += written;
+		size -= written;
 	}
 
-	memset(header->magic, 0, DBLL_MAGIC_SIZE);
-	header->ptr_size = 0;
-	header->data_size = 0;
-	header->empty_slot_ptr = 0;
-	header->list_size = 0;
-	header->header_size = 0;
+	pool_frame->is_dirty = 0;
 	return DBLL_OK;
 }
 
-int dbll_header_write(
-	dbll_header_t *header, 
-	dbll_state_t *state
-) {
-	if(
-		!dbll_header_valid(header) ||
-		!dbll_state_valid(state)
-	) {
-		return DBLL_ERR;
-	}
+static int pool_read_in(dbll_file_t *file, int frame) {
+	dbll_pool_t *pool = &file->pool;
+	dbll_index_t index = pool->frames[frame].page * DBLL_POOL_PAGE_SIZE;
+	uint8_t *mem = pool->mem + (size_t)(frame) * DBLL_POOL_PAGE_SIZE;
+	dbll_index_t size = DBLL_POOL_PAGE_SIZE;
+	while(size > 0) {
+		ssize_t result = pread(file->desc, mem, size, index);
+		if(result < 0) {
+			return DBLL_ERR;
+		}
 
-	// calculated in base one, but we need to go over
-	// one anyway so we get that addition for free.
-	// two for the two sizes in the head, one
-	// size for pointers, the other to describe the
-	// size of data sizes
-	int index = DBLL_MAGIC_SIZE + 2;
-	if(
-		dbll_ptr_index_copy(
-			state,
-			header->empty_slot_ptr,
-			index
-		) < 0
-	) {
-		return DBLL_ERR;
+		// past the end of the file, the rest is zero
+		if(result == 0) {
+			memset(mem, 0, size);
+			break;
+		}
+
+		mem += result;
+		index += result;
+		size -= result;
 	}
 
 	return DBLL_OK;
 }
 
-int dbll_list_valid(dbll_list_t *list) {
-	return (
-		DBLL_VALID(list != NULL) &&
-		DBLL_VALID(list->data_size >= 0) &&
-		DBLL_VALID(
-			(
-				list->head_ptr != list->this_ptr &&
-				list->tail_ptr != list->this_ptr &&
-				list->data_ptr != list->this_ptr
-			) || list->this_ptr == DBLL_NULL
-		)
-	);
-}
+// clock eviction, goes around the frames and takes the first one that
+// isn't pinned and hasn't been used since the last time around
+static int pool_evict(dbll_file_t *file) {
+	dbll_pool_t *pool = &file->pool;
+	for(int i = 0; i < pool->frame_count * 2 + 1; i++) {
+		int frame = pool->hand;
+		dbll_pool_frame_t *pool_frame = &pool->frames[frame];
+		pool->hand = (pool->hand + 1) % pool->frame_count;
+		if(pool_frame->pin_count > 0) {
+			continue;
+		}
 
-int dbll_list_load(
-	dbll_list_t *list, 
-	dbll_state_t *state, 
-	dbll_ptr_t ptr
-) {
-	if(!dbll_state_valid(state) || !dbll_list_valid(list)) {
-		return DBLL_ERR;
-	}
+		if(pool_frame->is_used) {
+			pool_frame->is_used = 0;
+			continue;
+		}
 
-	int index = dbll_ptr_to_index(state, ptr);
-	if(index == -1) {
-		return DBLL_ERR;
-	}
-	
-	int ptr_size = state->header.ptr_size;
-	if(
-		dbll_index_ptr_copy(
-			state, 
-			index,
-			&list->head_ptr
-		) < 0 ||
-		
-		dbll_index_ptr_copy(
-			state, 
-			index + ptr_size,
-			&list->tail_ptr
-		) < 0 ||
-		
-		dbll_index_ptr_copy(
-			state, 
-			index + (ptr_size * 2),
-			&list->data_ptr
-		) < 0 ||
+		if(pool_frame->page >= 0) {
+			if(
+				pool_frame->is_dirty &&
+				pool_write_back(file, frame) < 0
+			) {
+				return -1;
+			}
 
-		dbll_index_size_copy(
-			state,
-			index + (ptr_size * 3),
-			&list->data_size
-		) < 0
-	) {
-		dbll_list_unload(list);
-		return DBLL_ERR;
+			pool_forget(pool, frame);
+		}
+
+		return frame;
 	}
 
-	list->this_ptr = ptr;
-	return DBLL_OK;
+	// everything is pinned
+	return -1;
 }
 
-int dbll_list_unload(dbll_list_t *list) {
-	if(list == NULL) {
-		return DBLL_ERR;
+// gets the frame a page is in, reading it in if it isn't
+static int pool_frame(dbll_file_t *file, dbll_index_t page) {
+	dbll_pool_t *pool = &file->pool;
+	int frame = pool_find(pool, page);
+	if(frame >= 0) {
+		pool->frames[frame].is_used = 1;
+		return frame;
 	}
-	
-	list->head_ptr = DBLL_NULL;
-	list->tail_ptr = DBLL_NULL;
-	list->data_ptr = DBLL_NULL;
-	list->data_size = 0;
-	return DBLL_OK;
+
+	frame = pool_evict(file);
+	if(frame < 0) {
+		return -1;
+	}
+
+	int *bucket = pool_bucket(pool, page);
+	dbll_pool_frame_t *pool_frame = &pool->frames[frame];
+	pool_frame->page = page;
+	if(pool_read_in(file, frame) < 0) {
+		pool_frame->page = -1;
+		return -1;
+	}
+
+	pool_frame->next = *bucket;
+	pool_frame->is_used = 1;
+	*bucket = frame;
+	return frame;
 }
 
-int dbll_list_go(
-	dbll_list_t *list, 
-	dbll_state_t *state, 
-	list_go_e go
+// reads in every page that isn't in the pool yet, with one io_uring
+// submission for as many of them as it can take at a time
+static int pool_fetch(
+	dbll_file_t *file,
+	const dbll_index_t *pages,
+	dbll_index_t page_count
 ) {
-	if(
-		!dbll_list_valid(list) ||
-		!dbll_state_valid(state)
-	) {
-		return DBLL_ERR;
-	}
-	
-	dbll_ptr_t go_ptr = 0;
-	switch(go) {
-		case DBLL_GO_HEAD: {
-			go_ptr = list->head_ptr;
-			break;
+	dbll_pool_t *pool = &file->pool;
+	dbll_index_t i = 0;
+	while(i < page_count) {
+		int frames[DBLL_RING_ENTRIES] = { 0 };
+		uint8_t *buffers[DBLL_RING_ENTRIES] = { 0 };
+		dbll_index_t offsets[DBLL_RING_ENTRIES] = { 0 };
+		int results[DBLL_RING_ENTRIES] = { 0 };
+		int frame_count = 0;
+		int entry_count = pool->ring.desc >= 0
+			? (int)(pool->ring.entry_count)
+			: DBLL_RING_ENTRIES;
+
+		if(entry_count > DBLL_RING_ENTRIES) {
+			entry_count = DBLL_RING_ENTRIES;
 		}
-		
-		case DBLL_GO_TAIL: {
-			go_ptr = list->tail_ptr;
+
+		while(i < page_count && frame_count < entry_count) {
+			dbll_index_t page = pages[i];
+			i++;
+			if(
+				page < 0 ||
+				pool_find(pool, page) >= 0
+			) {
+				continue;
+			}
+
+			// the frame goes in its bucket and gets pinned right away,
+			// so the same page twice is only read once and the rest
+			// of the batch can't evict it
+			int frame = pool_evict(file);
+			if(frame < 0) {
+				break;
+			}
+
+			dbll_pool_frame_t *pool_frame = &pool->frames[frame];
+			int *bucket = pool_bucket(pool, page);
+			pool_frame->page = page;
+			pool_frame->next = *bucket;
+			pool_frame->is_used = 1;
+			pool_frame->pin_count++;
+			*bucket = frame;
+
+			frames[frame_count] = frame;
+			buffers[frame_count] = (
+				pool->mem + 
+				(size_t)(frame) * DBLL_POOL_PAGE_SIZE
+			);
+
+			offsets[frame_count] = page * DBLL_POOL_PAGE_SIZE;
+			results[frame_count] = -1;
+			frame_count++;
+		}
+
+		if(frame_count == 0) {
 			break;
 		}
-		
-		default: {
+
+		// if the ring breaks it's dropped and pread takes over
+		if(
+			pool->ring.desc >= 0 &&
+			ring_read(
+				&pool->ring,
+				file->desc,
+				buffers,
+				offsets,
+				results,
+				frame_count,
+				DBLL_POOL_PAGE_SIZE
+			) < 0
+		) {
+			ring_unload(&pool->ring);
+		}
+
+		int result = DBLL_OK;
+		for(int j = 0; j < frame_count; j++) {
+			dbll_pool_frame_t *pool_frame = &pool->frames[frames[j]];
+			pool_frame->pin_count--;
+
+			// short reads are the end of the file, pread zeroes it
+			if(
+				results[j] != DBLL_POOL_PAGE_SIZE &&
+				pool_read_in(file, frames[j]) < 0
+			) {
+				pool_forget(pool, frames[j]);
+				result = DBLL_ERR;
+			}
+		}
+
+		if(result < 0) {
+			return DBLL_ERR;
+		}
+	}
+
+	return DBLL_OK;
+}
+
+static int pool_flush(dbll_file_t *file) {
+	dbll_pool_t *pool = &file->pool;
+	for(int i = 0; i < pool->frame_count; i++) {
+		if(
+			pool->frames[i].is_dirty &&
+			pool_write_back(file, i) < 0
+		) {
+			return DBLL_ERR;
+		}
+	}
+
+	return DBLL_OK;
+}
+
+// the file shrunk, so any page past the end is thrown away, and
+// whatever is past the end in the last page is zeroed so it's
+// zero again if the file grows back
+static void pool_cut(dbll_file_t *file, size_t size) {
+	dbll_pool_t *pool = &file->pool;
+	for(int i = 0; i < pool->frame_count; i++) {
+		dbll_pool_frame_t *pool_frame = &pool->frames[i];
+		if(pool_frame->page < 0) {
+			continue;
+		}
+
+		dbll_index_t index = pool_frame->page * DBLL_POOL_PAGE_SIZE;
+		if(index >= size) {
+			pool_forget(pool, i);
+		} else if(index + DBLL_POOL_PAGE_SIZE > size) {
+			memset(
+				pool->mem + 
+				(size_t)(i) * DBLL_POOL_PAGE_SIZE +
+				(size - index),
+				0,
+				index + DBLL_POOL_PAGE_SIZE - size
+			);
+		}
+	}
+}
+
+// gives a pointer to size bytes of file memory at index. with a pool
+// it's only good until the next time the pool is used, and if the
+// bytes are split between pages they're copied into buffer instead
+static const uint8_t *file_view(
+	dbll_file_t *file,
+	dbll_index_t index,
+	dbll_index_t size,
+	uint8_t *buffer
+) {
+	if(
+		index < 0 ||
+		size < 0 ||
+		index + size > file->size
+	) {
+		return NULL;
+	}
+
+	if(!(file->flags & DBLL_OPEN_POOL)) {
+		return file->mem + index;
+	}
+
+	dbll_index_t offset = index % DBLL_POOL_PAGE_SIZE;
+	if(offset + size > DBLL_POOL_PAGE_SIZE) {
+		if(dbll_file_read(file, index, buffer, size) < 0) {
+			return NULL;
+		}
+
+		return buffer;
+	}
+
+	int frame = pool_frame(file, index / DBLL_POOL_PAGE_SIZE);
+	if(frame < 0) {
+		return NULL;
+	}
+
+	return (
+		file->pool.mem + 
+		(size_t)(frame) * DBLL_POOL_PAGE_SIZE + 
+		offset
+	);
+}
+
+static size_t page_size() {
+	static size_t size = 0;
+	if(size == 0) {
+		size = sysconf(_SC_PAGESIZE);
+	}
+
+	return size;
+}
+
+// rounds a size up to a multiple of the page size, mappings
+// always cover whole pages
+static size_t page_round(size_t size) {
+	return (size + page_size() - 1) / page_size() * page_size();
+}
+
+// marks the pages of file memory as dirty without checking the state,
+// everything that writes has already checked it by the time it's here
+static int state_mark_dirty(
+	dbll_state_t *state, 
+	dbll_index_t index, 
+	dbll_index_t size
+) {
+	if(size == 0 || state->file.flags & DBLL_OPEN_POOL) {
+		return DBLL_OK;
+	}
+
+	size_t first_page = index / page_size();
+	size_t last_page = (index + size - 1) / page_size();
+	if(last_page / 8 >= state->dirty_size) {
+		size_t dirty_size = state->dirty_size * 2;
+		if(dirty_size <= last_page / 8) {
+			dirty_size = last_page / 8 + 1;
+		}
+
+		uint8_t *dirty = realloc(state->dirty, dirty_size);
+		if(dirty == NULL) {
+			return DBLL_ERR;
+		}
+
+		memset(
+			dirty + state->dirty_size,
+			0,
+			dirty_size - state->dirty_size
+		);
+
+		state->dirty = dirty;
+		state->dirty_size = dirty_size;
+	}
+
+	for(size_t i = first_page; i <= last_page; i++) {
+		state->dirty[i / 8] |= 1 << (i % 8);
+	}
+
+	return DBLL_OK;
+}
+
+// every write to file memory goes through here so it gets synced
+static int state_write(
+	dbll_state_t *state,
+	dbll_index_t index,
+	const uint8_t *mem,
+	dbll_index_t size
+) {
+	if(
+		index < 0 ||
+		size < 0 ||
+		state_mark_dirty(state, index, size) < 0 ||
+		dbll_file_write(&state->file, index, mem, size) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+// address space that isn't backed by anything yet, it only
+// keeps other mappings from taking the range. new ranges are
+// aligned to DBLL_HUGEPAGE_SIZE, by reserving a bit more and
+// giving back what's before and after the aligned part
+static uint8_t *reserve_map(uint8_t *at, size_t size) {
+	size_t align_size = at == NULL
+		? DBLL_HUGEPAGE_SIZE
+		: 0;
+
+	uint8_t *mem = (uint8_t *)(
+		mmap(
+			at,
+			size + align_size,
+			PROT_NONE,
+			MAP_PRIVATE | 
+			MAP_ANONYMOUS | 
+			MAP_NORESERVE |
+			(at != NULL ? MAP_FIXED : 0),
+			-1,
+			0
+		)
+	);
+
+	if(mem == (uint8_t *)(-1) || align_size == 0) {
+		return mem;
+	}
+
+	uint8_t *aligned_mem = (uint8_t *)(
+		((uintptr_t)(mem) + align_size - 1) / 
+		align_size * 
+		align_size
+	);
+
+	if(aligned_mem > mem) {
+		munmap(mem, aligned_mem - mem);
+	}
+
+	if(aligned_mem + size < mem + size + align_size) {
+		munmap(
+			aligned_mem + size,
+			(mem + size + align_size) - (aligned_mem + size)
+		);
+	}
+
+	return aligned_mem;
+}
+
+// maps the part of the file from offset to size into the reserved
+// range, offset needs to be page aligned
+static int file_map_range(
+	dbll_file_t *file, 
+	size_t offset, 
+	size_t size
+) {
+	if(size <= offset) {
+		return DBLL_OK;
+	}
+
+	uint8_t *mem = (uint8_t *)(
+		mmap(
+			file->mem + offset,
+			size - offset,
+			file_prot(file),
+			MAP_SHARED | MAP_FIXED,
+			file->desc,
+			offset
+		)
+	);
+
+	if(mem == (uint8_t *)(-1)) {
+		return DBLL_ERR;
+	}
+
+	// every mapping is its own range as far as madvise
+	// cares, so every new one needs to be advised. not
+	// every file system can do huge pages for files,
+	// so it not working isn't an error
+	if(file->flags & DBLL_OPEN_HUGEPAGE) {
+		madvise(mem, size - offset, MADV_HUGEPAGE);
+	}
+
+	return DBLL_OK;
+}
+
+// the reserved range is full, so the mapping has to move into a bigger
+// one. mremap moves the page tables instead of copying anything
+static int file_move(dbll_file_t *file, size_t mapped_size) {
+	size_t reserve_size = file->reserve_size * 2;
+	if(reserve_size < mapped_size) {
+		reserve_size = page_round(mapped_size);
+	}
+
+	uint8_t *reserve = reserve_map(NULL, reserve_size);
+	if(reserve == (uint8_t *)(-1)) {
+		return DBLL_ERR;
+	}
+
+	size_t old_mapped_size = page_round(file->size);
+	uint8_t *mem = (uint8_t *)(
+		mremap(
+			file->mem,
+			old_mapped_size,
+			old_mapped_size,
+			MREMAP_MAYMOVE | MREMAP_FIXED,
+			reserve
+		)
+	);
+
+	if(mem == (uint8_t *)(-1)) {
+		munmap(reserve, reserve_size);
+		return DBLL_ERR;
+	}
+
+	// the old mapping is gone, but what was left of the
+	// old reserved range is still around
+	if(file->reserve_size > old_mapped_size) {
+		munmap(
+			file->mem + old_mapped_size,
+			file->reserve_size - old_mapped_size
+		);
+	}
+
+	file->mem = mem;
+	file->reserve_size = reserve_size;
+	return DBLL_OK;
+}
+
+int dbll_file_load(dbll_file_t *file, const char *path) {
+	return dbll_file_load_flags(file, path, DBLL_OPEN_DEFAULT);
+}
+
+int dbll_file_load_flags(
+	dbll_file_t *file, 
+	const char *path,
+	int flags
+) {
+	if(file == NULL || path == NULL) {
+		return DBLL_ERR;
+	}
+
+	// pwrite ignores the offset it's given with O_APPEND
+	int open_flags = flags & DBLL_OPEN_POOL
+		? O_RDWR
+		: O_RDWR | O_APPEND;
+
+	file->desc = open(
+		path, 
+		flags & DBLL_OPEN_READONLY
+			? O_RDONLY
+			: open_flags
+	);
+
+	if(file->desc < 0) {
+		return DBLL_ERR;
+	}
+
+	// nothing is mapped with a pool
+	if(flags & DBLL_OPEN_POOL) {
+		flags &= ~(DBLL_OPEN_STABLE | DBLL_OPEN_HUGEPAGE);
+	}
+
+	if(flags & DBLL_OPEN_HUGEPAGE) {
+		flags |= DBLL_OPEN_STABLE;
+	}
+
+	file->flags = flags;
+	dbll_index_t size = file_size(file->desc);
+	if(size <= 0) {
+		dbll_file_unload(file);
+		return DBLL_ERR;
+	}
+
+	file->size = size;
+	if(flags & DBLL_OPEN_POOL) {
+		if(pool_load(&file->pool, DBLL_POOL_FRAMES) < 0) {
+			dbll_file_unload(file);
+			return DBLL_ERR;
+		}
+
+		return DBLL_OK;
+	}
+
+	if(flags & DBLL_OPEN_STABLE) {
+		file->reserve_size = DBLL_RESERVE_SIZE;
+		if(file->reserve_size < file->size) {
+			file->reserve_size = page_round(file->size);
+		}
+
+		file->mem = reserve_map(NULL, file->reserve_size);
+		if(file->mem == (uint8_t *)(-1)) {
+			file->mem = NULL;
+			dbll_file_unload(file);
+			return DBLL_ERR;
+		}
+
+		if(file_map_range(file, 0, file->size) < 0) {
+			dbll_file_unload(file);
+			return DBLL_ERR;
+		}
+
+		return DBLL_OK;
+	}
+
+	file->mem = (uint8_t*)(
+		mmap(
+			NULL,
+			file->size,
+			file_prot(file),
+			MAP_SHARED,
+			file->desc,
+			0
+		)
+	);
+
+	if(file->mem == (uint8_t *)(-1)) {
+		file->mem = NULL;
+		dbll_file_unload(file);
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_file_unload(dbll_file_t *file) {
+	if(file == NULL) {
+		return DBLL_ERR;
+	}
+
+	size_t mapped_size = file->reserve_size > 0
+		? file->reserve_size
+		: file->size;
+
+	// unmapping doesn't throw away anything written to the file,
+	// syncing it is up to dbll_file_sync
+	if(
+		file->mem != NULL &&
+		munmap(file->mem, mapped_size) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	// the pool is the only place some writes are in, so they have
+	// to get to the file no matter what, even if they aren't synced
+	if(file->pool.frames != NULL) {
+		int result = pool_flush(file);
+		pool_unload(&file->pool);
+		if(result < 0) {
+			return DBLL_ERR;
+		}
+	}
+
+	if(
+		file->desc > 0 &&
+		close(file->desc) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	file->mem = NULL;
+	file->size = 0;
+	file->desc = 0;
+	file->flags = 0;
+	file->reserve_size = 0;
+	return DBLL_OK;
+}
+
+// big endian, done manually and not with memcpy to enforce endianness
+static void header_put(uint8_t *mem, uint64_t value, int size) {
+	for(int i = 0; i < size; i++) {
+		mem[size - 1 - i] = (value >> (i * 8)) & 0xff;
+	}
+}
+
+static uint64_t header_get(const uint8_t *mem, int size) {
+	uint64_t value = 0;
+	for(int i = 0; i < size; i++) {
+		value |= (uint64_t)(mem[size - 1 - i]) << (i * 8);
+	}
+
+	return value;
+}
+
+// every field width gets its own functions so reading or writing a
+// field is one load or store, and a byte swap for big endian
+#define FIELD_FUNCS(_order, _bits) \
+	static inline uint64_t field_get_##_order##_bits(const uint8_t *mem) { \
+		uint##_bits##_t value = 0; \
+		memcpy(&value, mem, sizeof(value)); \
+		return _order##_bits##toh(value); \
+	} \
+	\
+	static inline void field_put_##_order##_bits(uint8_t *mem, uint64_t value) { \
+		uint##_bits##_t field = hto##_order##_bits(value); \
+		memcpy(mem, &field, sizeof(field)); \
+	}
+
+FIELD_FUNCS(be, 16)
+FIELD_FUNCS(be, 32)
+FIELD_FUNCS(be, 64)
+FIELD_FUNCS(le, 16)
+FIELD_FUNCS(le, 32)
+FIELD_FUNCS(le, 64)
+
+// one byte fields don't have an order, and there's no 24 bit
+// integer, those are put together by hand
+static inline uint64_t field_get_be8(const uint8_t *mem) {
+	return mem[0];
+}
+
+static inline void field_put_be8(uint8_t *mem, uint64_t value) {
+	mem[0] = value;
+}
+
+static inline uint64_t field_get_le8(const uint8_t *mem) {
+	return mem[0];
+}
+
+static inline void field_put_le8(uint8_t *mem, uint64_t value) {
+	mem[0] = value;
+}
+
+static inline uint64_t field_get_be24(const uint8_t *mem) {
+	return ((uint64_t)(mem[0]) << 16) | (mem[1] << 8) | mem[2];
+}
+
+static inline void field_put_be24(uint8_t *mem, uint64_t value) {
+	mem[0] = value >> 16;
+	mem[1] = value >> 8;
+	mem[2] = value;
+}
+
+static inline uint64_t field_get_le24(const uint8_t *mem) {
+	return ((uint64_t)(mem[2]) << 16) | (mem[1] << 8) | mem[0];
+}
+
+static inline void field_put_le24(uint8_t *mem, uint64_t value) {
+	mem[0] = value;
+	mem[1] = value >> 8;
+	mem[2] = value >> 16;
+}
+
+// reads and writes fields and whole blocks for one pointer size,
+// data size and format, so the sizes are constants in all of them
+typedef struct dbll_codec_s {
+	uint64_t (*ptr_get)(const uint8_t *);
+	void (*ptr_put)(uint8_t *, uint64_t);
+	uint64_t (*size_get)(const uint8_t *);
+	void (*size_put)(uint8_t *, uint64_t);
+	void (*list_get)(const uint8_t *, dbll_list_t *);
+	void (*list_put)(uint8_t *, const dbll_list_t *);
+	void (*empty_get)(const uint8_t *, dbll_empty_slot_t *);
+	void (*empty_put)(uint8_t *, const dbll_empty_slot_t *);
+} dbll_codec_t;
+
+#define CODEC_FUNCS(_order, _ptr, _size) \
+	static void list_get_##_order##_ptr##_##_size( \
+		const uint8_t *mem, \
+		dbll_list_t *list \
+	) { \
+		list->head_ptr = field_get_##_order##_ptr(mem); \
+		list->tail_ptr = field_get_##_order##_ptr(mem + (_ptr / 8)); \
+		list->data_ptr = field_get_##_order##_ptr(mem + (_ptr / 8) * 2); \
+		list->data_size = field_get_##_order##_size(mem + (_ptr / 8) * 3); \
+	} \
+	\
+	static void list_put_##_order##_ptr##_##_size( \
+		uint8_t *mem, \
+		const dbll_list_t *list \
+	) { \
+		field_put_##_order##_ptr(mem, list->head_ptr); \
+		field_put_##_order##_ptr(mem + (_ptr / 8), list->tail_ptr); \
+		field_put_##_order##_ptr(mem + (_ptr / 8) * 2, list->data_ptr); \
+		field_put_##_order##_size(mem + (_ptr / 8) * 3, list->data_size); \
+	} \
+	\
+	static void empty_get_##_order##_ptr##_##_size( \
+		const uint8_t *mem, \
+		dbll_empty_slot_t *slot \
+	) { \
+		slot->this_ptr = field_get_##_order##_ptr(mem); \
+		slot->prev_ptr = field_get_##_order##_ptr(mem + (_ptr / 8)); \
+		slot->next_ptr = field_get_##_order##_ptr(mem + (_ptr / 8) * 2); \
+	} \
+	\
+	static void empty_put_##_order##_ptr##_##_size( \
+		uint8_t *mem, \
+		const dbll_empty_slot_t *slot \
+	) { \
+		field_put_##_order##_ptr(mem, slot->this_ptr); \
+		field_put_##_order##_ptr(mem + (_ptr / 8), slot->prev_ptr); \
+		field_put_##_order##_ptr(mem + (_ptr / 8) * 2, slot->next_ptr); \
+	} \
+	\
+	static const dbll_codec_t codec_##_order##_ptr##_##_size = { \
+		field_get_##_order##_ptr, \
+		field_put_##_order##_ptr, \
+		field_get_##_order##_size, \
+		field_put_##_order##_size, \
+		list_get_##_order##_ptr##_##_size, \
+		list_put_##_order##_ptr##_##_size, \
+		empty_get_##_order##_ptr##_##_size, \
+		empty_put_##_order##_ptr##_##_size \
+	};
+
+// data sizes go up to DBLL_SIZE_MAX
+#define CODEC_SIZES(_order, _ptr) \
+	CODEC_FUNCS(_order, _ptr, 8) \
+	CODEC_FUNCS(_order, _ptr, 16) \
+	CODEC_FUNCS(_order, _ptr, 24) \
+	CODEC_FUNCS(_order, _ptr, 32)
+
+CODEC_SIZES(be, 8)
+CODEC_SIZES(be, 16)
+CODEC_SIZES(be, 32)
+CODEC_SIZES(be, 64)
+CODEC_SIZES(le, 8)
+CODEC_SIZES(le, 16)
+CODEC_SIZES(le, 32)
+CODEC_SIZES(le, 64)
+
+#define CODEC_ROW(_order, _ptr) \
+	{ \
+		&codec_##_order##_ptr##_8, \
+		&codec_##_order##_ptr##_16, \
+		&codec_##_order##_ptr##_24, \
+		&codec_##_order##_ptr##_32 \
+	}
+
+// by format, then pointer size (1, 2, 4, 8), then data size (1 to 4)
+static const dbll_codec_t *const codecs[2][4][DBLL_SIZE_MAX] = {
+	{
+		CODEC_ROW(be, 8),
+		CODEC_ROW(be, 16),
+		CODEC_ROW(be, 32),
+		CODEC_ROW(be, 64)
+	}, {
+		CODEC_ROW(le, 8),
+		CODEC_ROW(le, 16),
+		CODEC_ROW(le, 32),
+		CODEC_ROW(le, 64)
+	}
+};
+
+// sizes that can't be in a valid header get no codec
+static void header_codec(dbll_header_t *header) {
+	int ptr_row = -1;
+	switch(header->ptr_size) {
+		case 1: ptr_row = 0; break;
+		case 2: ptr_row = 1; break;
+		case 4: ptr_row = 2; break;
+		case 8: ptr_row = 3; break;
+	}
+
+	header->codec = NULL;
+	if(
+		ptr_row >= 0 &&
+		header->data_size > 0 &&
+		header->data_size <= DBLL_SIZE_MAX
+	) {
+		header->codec = codecs
+			[(header->flags & DBLL_FORMAT_NATIVE) != 0]
+			[ptr_row]
+			[header->data_size - 1];
+	}
+}
+
+static uint32_t header_checksum(const uint8_t *mem, int size) {
+	uint32_t hash = 2166136261u;
+	for(int i = 0; i < size; i++) {
+		hash ^= mem[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+// every format flag the library knows about
+static const int format_flags = DBLL_FORMAT_NATIVE | DBLL_FORMAT_ALIGNED;
+
+// how big the header is in the file, without padding
+static int header_encode_size(dbll_header_t *header) {
+	if(header->version >= 3) {
+		return DBLL_MAGIC_SIZE + 2 + (header->ptr_size * 3) + 21;
+	}
+
+	return header->version >= 2
+		? DBLL_MAGIC_SIZE + 2 + (header->ptr_size * 2) + 21
+		: DBLL_MAGIC_SIZE + 2 + header->ptr_size;
+}
+
+static void header_sizes(dbll_header_t *header) {
+	header->header_size = header_encode_size(header);
+
+	// 3 because that's how many pointers are in dbll_list_t
+	// and empty_slot_size
+	header->list_size = (header->ptr_size * 3) + header->data_size;
+	header->empty_slot_size = (header->ptr_size * 3) + 1;
+	header->data_slot_size = header->list_size - header->ptr_size;
+	header->block_size = header->list_size;
+	if(header->flags & DBLL_FORMAT_ALIGNED) {
+		header->block_size = 1;
+		while(header->block_size < header->list_size) {
+			header->block_size *= 2;
+		}
+
+		header->header_size = (
+			(header->header_size + DBLL_CACHE_LINE - 1) / 
+			DBLL_CACHE_LINE * 
+			DBLL_CACHE_LINE
+		);
+	}
+
+	header->block_shift = 0;
+	if((header->block_size & (header->block_size - 1)) == 0) {
+		while((1 << header->block_shift) < header->block_size) {
+			header->block_shift++;
+		}
+	}
+
+	// the top two bits of a list's data size are its data kind
+	header->kind_shift = header->data_size * 8;
+	if(header->version >= 2) {
+		header->kind_shift -= 2;
+	}
+}
+
+// puts the header the way it is in the file into mem, which has to
+// fit DBLL_HEADER_MAX. the checksum is worked out here too
+static void header_encode(dbll_header_t *header, uint8_t *mem) {
+	int ptr_size = header->ptr_size;
+	memcpy(mem, header->magic, DBLL_MAGIC_SIZE);
+	mem[DBLL_MAGIC_SIZE] = ptr_size;
+	mem[DBLL_MAGIC_SIZE + 1] = (header->version << 4) | header->data_size;
+
+	uint8_t *field = mem + DBLL_MAGIC_SIZE + 2;
+	header_put(field, header->empty_slot_ptr, ptr_size);
+	if(header->version < 2) {
+		return;
+	}
+
+	field += ptr_size;
+	header_put(field, header->first_empty_ptr, ptr_size);
+	field += ptr_size;
+	*field = header->flags;
+	field++;
+	header_put(field, header->block_count, 8);
+	field += 8;
+	header_put(field, header->capacity, 8);
+	field += 8;
+	if(header->version >= 3) {
+		header_put(field, header->class_ptr, ptr_size);
+		field += ptr_size;
+	}
+
+	header->checksum = header_checksum(mem, field - mem);
+	header_put(field, header->checksum, 4);
+}
+
+// new files have 4 byte pointers and sizes, and an empty root list
+static const dbll_header_t file_boilerplate = {
+	.magic = { 'd', 'b', 'l', 'l' },
+	.ptr_size = 4,
+	.data_size = 4,
+	.version = DBLL_HEADER_VERSION,
+	.block_count = 1,
+	.capacity = 1
+};
+
+int dbll_file_make(dbll_file_t *file, const char *path) {
+	if(file == NULL || path == NULL) {
+		return DBLL_ERR;
+	}
+	
+	// can't make already existing file
+	if(access(path, F_OK) >= 0) {
+		return DBLL_ERR;
+	}
+	
+	int desc = open(path, O_RDWR | O_CREAT);
+	if(desc < 0) {
+		return DBLL_ERR;
+	}
+
+	dbll_header_t header = file_boilerplate;
+	uint8_t mem[DBLL_HEADER_MAX + (DBLL_PTR_MAX * 3) + DBLL_SIZE_MAX] = { 0 };
+	header_sizes(&header);
+	header_encode(&header, mem);
+	if(
+		write(
+			desc, 
+			mem, 
+			header.header_size + header.list_size
+		) < 0
+	) {
+
+		// don't care for errors on this close
+		// because something screwed up anyway
+		close(desc);
+		return DBLL_ERR;
+	}
+	
+	if(close(desc) < 0) {
+		return DBLL_ERR;
+	}
+	
+	if(
+		dbll_file_load(
+			file,
+			path
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_file_resize(dbll_file_t *file, dbll_index_t size) {
+	if(
+		!dbll_file_valid(file) ||
+		file->flags & DBLL_OPEN_READONLY ||
+		(dbll_index_t)(file->size) + size <= 0
+	) {
+		return DBLL_ERR;
+	}
+
+	size_t new_size = file->size + size;
+	size_t mapped_size = page_round(file->size);
+	size_t new_mapped_size = page_round(new_size);
+	if(file->flags & DBLL_OPEN_POOL) {
+		if(
+			ftruncate(
+				file->desc, 
+				new_size
+			) < 0
+		) {
+			return DBLL_ERR;
+		}
+
+		pool_cut(file, new_size);
+		file->size = new_size;
+		return DBLL_OK;
+	}
+
+	if(!(file->flags & DBLL_OPEN_STABLE)) {
+		if(
+			ftruncate(
+				file->desc, 
+				new_size
+			) < 0
+		) {
+			return DBLL_ERR;
+		}
+
+		uint8_t *mem = (uint8_t *)(
+			mremap(
+				file->mem,
+				mapped_size,
+				new_mapped_size,
+				MREMAP_MAYMOVE
+			)
+		);
+
+		if(mem == (uint8_t *)(-1)) {
+			return DBLL_ERR;
+		}
+
+		file->mem = mem;
+		file->size = new_size;
+		return DBLL_OK;
+	}
+
+	// pages past the end go back to being reserved, before the
+	// file shrinks so they can't be touched past its end
+	if(
+		new_mapped_size < mapped_size &&
+		reserve_map(
+			file->mem + new_mapped_size,
+			mapped_size - new_mapped_size
+		) == (uint8_t *)(-1)
+	) {
+		return DBLL_ERR;
+	}
+
+	if(
+		ftruncate(
+			file->desc, 
+			new_size
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	if(
+		new_mapped_size > file->reserve_size &&
+		file_move(file, new_mapped_size) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	if(
+		file_map_range(
+			file,
+			mapped_size,
+			new_mapped_size
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	file->size = new_size;
+	return DBLL_OK;
+}
+
+static const int advise_flags[] = {
+	MADV_NORMAL,
+	MADV_RANDOM,
+	MADV_SEQUENTIAL,
+	MADV_WILLNEED,
+	MADV_DONTNEED
+};
+
+// index doesn't need to be page aligned, the range is
+// widened to the pages it touches
+static int file_advise_range(
+	dbll_file_t *file,
+	dbll_index_t index,
+	dbll_index_t size,
+	dbll_advise_e advise
+) {
+
+	// the pool decides what's in memory by itself
+	if(file->flags & DBLL_OPEN_POOL) {
+		return DBLL_OK;
+	}
+
+	if(
+		index < 0 ||
+		size <= 0 ||
+		index >= file->size ||
+		advise < DBLL_ADVISE_NORMAL ||
+		advise > DBLL_ADVISE_DONTNEED
+	) {
+		return DBLL_ERR;
+	}
+
+	if(index + size > file->size) {
+		size = file->size - index;
+	}
+
+	dbll_index_t start = index / page_size() * page_size();
+	if(
+		madvise(
+			file->mem + start,
+			size + (index - start),
+			advise_flags[advise]
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+// index needs to be page aligned
+static int file_sync_range(
+	dbll_file_t *file,
+	size_t index,
+	size_t size,
+	int is_async
+) {
+	if(index >= file->size) {
+		return DBLL_OK;
+	}
+
+	if(index + size > file->size) {
+		size = file->size - index;
+	}
+
+	if(
+		msync(
+			file->mem + index,
+			size,
+			is_async 
+				? MS_ASYNC 
+				: MS_SYNC
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+// is_async starts writing back the file without waiting for it
+int dbll_file_sync(dbll_file_t *file, int is_async) {
+	if(!dbll_file_valid(file)) {
+		return DBLL_ERR;
+	}
+
+	if(!(file->flags & DBLL_OPEN_POOL)) {
+		return file_sync_range(file, 0, file->size, is_async);
+	}
+
+	if(pool_flush(file) < 0) {
+		return DBLL_ERR;
+	}
+
+	if(!is_async && fdatasync(file->desc) < 0) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+// copies file memory, this and dbll_file_write work the same no
+// matter if the file is mapped or in a pool
+int dbll_file_read(
+	dbll_file_t *file,
+	dbll_index_t index,
+	uint8_t *mem,
+	dbll_index_t size
+) {
+	if(
+		!dbll_file_valid(file) ||
+		mem == NULL ||
+		index < 0 ||
+		size < 0 ||
+		index + size > file->size
+	) {
+		return DBLL_ERR;
+	}
+
+	if(!(file->flags & DBLL_OPEN_POOL)) {
+		memcpy(mem, file->mem + index, size);
+		return DBLL_OK;
+	}
+
+	while(size > 0) {
+		dbll_index_t offset = index % DBLL_POOL_PAGE_SIZE;
+		dbll_index_t copy_size = DBLL_POOL_PAGE_SIZE - offset;
+		if(copy_size > size) {
+			copy_size = size;
+		}
+
+		int frame = pool_frame(file, index / DBLL_POOL_PAGE_SIZE);
+		if(frame < 0) {
+			return DBLL_ERR;
+		}
+
+		memcpy(
+			mem,
+			file->pool.mem + 
+			(size_t)(frame) * DBLL_POOL_PAGE_SIZE + 
+			offset,
+			copy_size
+		);
+
+		mem += copy_size;
+		index += copy_size;
+		size -= copy_size;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_file_write(
+	dbll_file_t *file,
+	dbll_index_t index,
+	const uint8_t *mem,
+	dbll_index_t size
+) {
+	if(
+		!dbll_file_valid(file) ||
+		file->flags & DBLL_OPEN_READONLY ||
+		mem == NULL ||
+		index < 0 ||
+		size < 0 ||
+		index + size > file->size
+	) {
+		return DBLL_ERR;
+	}
+
+	if(!(file->flags & DBLL_OPEN_POOL)) {
+		memcpy(file->mem + index, mem, size);
+		return DBLL_OK;
+	}
+
+	while(size > 0) {
+		dbll_index_t offset = index % DBLL_POOL_PAGE_SIZE;
+		dbll_index_t copy_size = DBLL_POOL_PAGE_SIZE - offset;
+		if(copy_size > size) {
+			copy_size = size;
+		}
+
+		int frame = pool_frame(file, index / DBLL_POOL_PAGE_SIZE);
+		if(frame < 0) {
+			return DBLL_ERR;
+		}
+
+		memcpy(
+			file->pool.mem + 
+			(size_t)(frame) * DBLL_POOL_PAGE_SIZE + 
+			offset,
+			mem,
+			copy_size
+		);
+
+		file->pool.frames[frame].is_dirty = 1;
+		mem += copy_size;
+		index += copy_size;
+		size -= copy_size;
+	}
+
+	return DBLL_OK;
+}
+
+// gives a pointer to file memory at index, that stays good until it's
+// unpinned. with a pool, the pointer only goes up to the end of the page
+// and the page counts as dirty, since it could be written to
+int dbll_file_pin(
+	dbll_file_t *file,
+	dbll_index_t index,
+	uint8_t **mem
+) {
+	if(
+		!dbll_file_valid(file) ||
+		mem == NULL ||
+		index < 0 ||
+		index >= file->size
+	) {
+		return DBLL_ERR;
+	}
+
+	if(!(file->flags & DBLL_OPEN_POOL)) {
+		*mem = file->mem + index;
+		return DBLL_OK;
+	}
+
+	int frame = pool_frame(file, index / DBLL_POOL_PAGE_SIZE);
+	if(frame < 0) {
+		return DBLL_ERR;
+	}
+
+	file->pool.frames[frame].pin_count++;
+	if(!(file->flags & DBLL_OPEN_READONLY)) {
+		file->pool.frames[frame].is_dirty = 1;
+	}
+
+	*mem = (
+		file->pool.mem + 
+		(size_t)(frame) * DBLL_POOL_PAGE_SIZE +
+		index % DBLL_POOL_PAGE_SIZE
+	);
+
+	return DBLL_OK;
+}
+
+// gets size bytes at every index into memory ahead of time. with a pool
+// the pages are read in batches through io_uring, otherwise the kernel
+// is told they'll be needed
+int dbll_file_fetch(
+	dbll_file_t *file,
+	const dbll_index_t *indexes,
+	dbll_index_t count,
+	dbll_index_t size
+) {
+	if(
+		!dbll_file_valid(file) ||
+		indexes == NULL ||
+		count < 0 ||
+		size <= 0
+	) {
+		return DBLL_ERR;
+	}
+
+	dbll_index_t fetch_page_size = file->flags & DBLL_OPEN_POOL
+		? DBLL_POOL_PAGE_SIZE
+		: (dbll_index_t)(page_size());
+
+	dbll_index_t page_count = 0;
+	for(dbll_index_t i = 0; i < count; i++) {
+		dbll_index_t index = indexes[i];
+		if(
+			index < 0 ||
+			index + size > file->size
+		) {
+			return DBLL_ERR;
+		}
+
+		page_count += (
+			(index + size - 1) / fetch_page_size - 
+			index / fetch_page_size + 
+			1
+		);
+	}
+
+	dbll_index_t *pages = malloc(page_count * sizeof(dbll_index_t) + 1);
+	if(pages == NULL) {
+		return DBLL_ERR;
+	}
+
+	// pages next to each other are only asked for once
+	dbll_index_t last_page = -1;
+	page_count = 0;
+	for(dbll_index_t i = 0; i < count; i++) {
+		dbll_index_t index = indexes[i];
+		for(
+			dbll_index_t page = index / fetch_page_size; 
+			page <= (index + size - 1) / fetch_page_size; 
+			page++
+		) {
+			if(page != last_page) {
+				pages[page_count] = page;
+				page_count++;
+				last_page = page;
+			}
+		}
+	}
+
+	int result = DBLL_OK;
+	if(file->flags & DBLL_OPEN_POOL) {
+		result = pool_fetch(file, pages, page_count);
+	} else {
+		for(dbll_index_t i = 0; i < page_count; i++) {
+			file_advise_range(
+				file,
+				pages[i] * fetch_page_size,
+				fetch_page_size,
+				DBLL_ADVISE_WILLNEED
+			);
+		}
+	}
+
+	free(pages);
+	return result;
+}
+
+int dbll_file_unpin(dbll_file_t *file, dbll_index_t index) {
+	if(
+		!dbll_file_valid(file) ||
+		index < 0 ||
+		index >= file->size
+	) {
+		return DBLL_ERR;
+	}
+
+	if(!(file->flags & DBLL_OPEN_POOL)) {
+		return DBLL_OK;
+	}
+
+	int frame = pool_find(
+		&file->pool, 
+		index / DBLL_POOL_PAGE_SIZE
+	);
+
+	if(
+		frame < 0 ||
+		file->pool.frames[frame].pin_count <= 0
+	) {
+		return DBLL_ERR;
+	}
+
+	file->pool.frames[frame].pin_count--;
+	return DBLL_OK;
+}
+
+// the magic number spells out "dbll" but in decimal form
+static const uint32_t dbll_header_magic = 1819042404;
+int dbll_header_valid(dbll_header_t *header) {
+	uint32_t magic_int = *((uint32_t *)(header->magic));
+	return (
+		DBLL_VALID(header != NULL) &&
+		DBLL_VALID(magic_int == dbll_header_magic) && DBLL_VALID(
+			header->ptr_size == 1 ||
+			header->ptr_size == 2 ||
+			header->ptr_size == 4 ||
+			header->ptr_size == 8
+		) &&
+
+		DBLL_VALID(header->data_size > 0) &&
+		DBLL_VALID(header->data_size <= DBLL_SIZE_MAX) &&
+		DBLL_VALID(header->list_size > 0) &&
+		DBLL_VALID(header->header_size > 0) &&
+		DBLL_VALID(header->codec != NULL)
+	);
+}
+
+int dbll_header_load(dbll_header_t *header, dbll_file_t *file) {
+	if(!dbll_file_valid(file) || header == NULL) {
+		return DBLL_ERR;
+	}
+
+	uint8_t mem[DBLL_HEADER_MAX] = { 0 };
+	dbll_index_t mem_size = sizeof(mem);
+	if(mem_size > file->size) {
+		mem_size = file->size;
+	}
+
+	if(dbll_file_read(file, 0, mem, mem_size) < 0) {
+		return DBLL_ERR;
+	}
+
+	memcpy(header->magic, &mem[0], DBLL_MAGIC_SIZE);
+	header->ptr_size = mem[DBLL_MAGIC_SIZE];
+	header->data_size = mem[DBLL_MAGIC_SIZE + 1] & 0x0f;
+	header->version = mem[DBLL_MAGIC_SIZE + 1] >> 4;
+	if(
+		header->ptr_size > DBLL_PTR_MAX ||
+		header->data_size > DBLL_SIZE_MAX ||
+		header->version == 1 ||
+		header->version > DBLL_HEADER_VERSION
+	) {
+		return DBLL_ERR;
+	}
+
+	header_sizes(header);
+	if(header->header_size > file->size) {
+		return DBLL_ERR;
+	}
+
+	int ptr_size = header->ptr_size;
+	const uint8_t *field = mem + DBLL_MAGIC_SIZE + 2;
+	header->empty_slot_ptr = header_get(field, ptr_size);
+	if(header->version < 2) {
+
+		// the file doesn't keep track of where the blocks end, so anything
+		// that fits is counted as a block
+		header->first_empty_ptr = DBLL_NULL;
+		header->class_ptr = DBLL_NULL;
+		header->flags = 0;
+		header->block_count = (
+			file->size -
+			header->header_size
+		) / header->block_size;
+
+		header->capacity = header->block_count;
+		header->checksum = 0;
+		header_codec(header);
+		return DBLL_OK;
+	}
+
+	field += ptr_size;
+	header->first_empty_ptr = header_get(field, ptr_size);
+	field += ptr_size;
+	header->flags = *field;
+	field++;
+	header->block_count = header_get(field, 8);
+	field += 8;
+	header->capacity = header_get(field, 8);
+	field += 8;
+	header->class_ptr = DBLL_NULL;
+	if(header->version >= 3) {
+		header->class_ptr = header_get(field, ptr_size);
+		field += ptr_size;
+	}
+
+	header->checksum = header_get(field, 4);
+
+	// the flags can change the sizes
+	header_sizes(header);
+
+	// capacity isn't checked against the file, trimming the file
+	// before the header gets written again is fine, losing blocks isn't
+	if(
+		header->checksum != header_checksum(mem, field - mem) ||
+		header->flags & ~format_flags ||
+		header->header_size > file->size ||
+		header->block_count > header->capacity ||
+		header->block_count > (
+			file->size -
+			header->header_size
+		) / header->block_size
+	) {
+		return DBLL_ERR;
+	}
+
+	header_codec(header);
+	return DBLL_OK;
+}
+
+int dbll_header_unload(dbll_header_t *header) {
+	if(!dbll_header_valid(header)) {
+		return DBLL_ERR;
+	}
+
+	*header = (dbll_header_t) { 0 };
+	return DBLL_OK;
+}
+
+int dbll_header_write(
+	dbll_header_t *header, 
+	dbll_state_t *state
+) {
+	if(
+		!dbll_header_valid(header) ||
+		!dbll_state_valid(state) ||
+		!state_writable(state)
+	) {
+		return DBLL_ERR;
+	}
+
+	// the capacity is whatever fits in the file right now
+	header->capacity = (
+		state->file.size -
+		header->header_size
+	) / header->block_size;
+
+	uint8_t mem[DBLL_HEADER_MAX] = { 0 };
+	header_encode(header, mem);
+
+	// version 0 headers only have the empty slot pointer to change,
+	// it's after the magic and the two sizes
+	dbll_index_t index = header->version < 2
+		? DBLL_MAGIC_SIZE + 2
+		: 0;
+
+	if(
+		state_write(
+			state,
+			index,
+			mem + index,
+			header_encode_size(header) - index
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+// the trusted tier. everything below checks the state once when it's
+// called and then reads blocks through these, which only check that
+// the pointer is a block. checking the whole state costs more than
+// reading a list does, so doing it once per read made up most of the
+// time spent going through a tree
+static inline dbll_index_t state_index(
+	dbll_state_t *state,
+	dbll_ptr_t ptr
+) {
+	// because 0 is reserved, indices are one-based
+	// so ptr is subtracted to convert it back to
+	// zero-base in order for conversion to happen
+	// anything past block_count is spare capacity, not a block
+	if(ptr == DBLL_NULL || ptr > state->header.block_count) {
+		return -1;
+	}
+
+	ptr--;
+	dbll_index_t offset = state->header.header_size;
+	dbll_index_t index = state->header.block_shift > 0
+		? offset + (ptr << state->header.block_shift)
+		: offset + (ptr * state->header.block_size);
+	if(index < 0 || index >= state->file.size) {
+		return -1;
+	}
+
+	return index;
+}
+
+static inline int index_ptr_read(
+	dbll_state_t *state,
+	dbll_index_t index,
+	dbll_ptr_t *ptr
+) {
+	uint8_t buffer[DBLL_PTR_MAX] = { 0 };
+	const uint8_t *mem = file_view(
+		&state->file,
+		index,
+		state->header.ptr_size,
+		buffer
+	);
+
+	if(mem == NULL) {
+		return DBLL_ERR;
+	}
+
+	*ptr = state->header.codec->ptr_get(mem);
+	return DBLL_OK;
+}
+
+static inline int index_ptr_write(
+	dbll_state_t *state,
+	dbll_index_t index,
+	dbll_ptr_t ptr
+) {
+	uint8_t mem[DBLL_PTR_MAX] = { 0 };
+	state->header.codec->ptr_put(mem, ptr);
+	return state_write(state, index, mem, state->header.ptr_size);
+}
+
+// how many bytes of data a list can hold itself
+static inline int list_inline_max(dbll_state_t *state) {
+	return state->header.ptr_size + state->header.data_size - 1;
+}
+
+// the most bytes of data a list can have, data_size has to fit in
+// however many bytes the header says sizes are, under the data kind
+static inline dbll_index_t list_data_max(dbll_state_t *state) {
+	return ((dbll_index_t)(1) << state->header.kind_shift) - 1;
+}
+
+static inline int list_read(
+	dbll_list_t *list,
+	dbll_state_t *state,
+	dbll_ptr_t ptr
+) {
+	uint8_t buffer[DBLL_PTR_MAX * 3 + DBLL_SIZE_MAX] = { 0 };
+	dbll_index_t index = state_index(state, ptr);
+	const uint8_t *mem = index < 0
+		? NULL
+		: file_view(
+			&state->file,
+			index,
+			state->header.list_size,
+			buffer
+		);
+
+	if(mem == NULL) {
+		dbll_list_unload(list);
+		return DBLL_ERR;
+	}
+
+	state->header.codec->list_get(mem, list);
+	uint64_t data_size = list->data_size;
+	list->data_kind = data_size >> state->header.kind_shift;
+	list->data_size &= list_data_max(state);
+	if(list->data_kind == DBLL_DATA_INLINE) {
+		dbll_list_inline_get(
+			list,
+			list->data_ptr,
+			data_size,
+			state->header.ptr_size,
+			state->header.kind_shift
+		);
+	}
+
+	list->this_ptr = ptr;
+	list->data_tail_ptr = DBLL_NULL;
+	list->data_generation = 0;
+	return DBLL_OK;
+}
+
+static inline int empty_slot_read(
+	dbll_empty_slot_t *slot,
+	dbll_state_t *state,
+	dbll_ptr_t ptr
+) {
+	uint8_t buffer[DBLL_PTR_MAX * 3] = { 0 };
+	dbll_index_t index = state_index(state, ptr);
+	const uint8_t *mem = index < 0
+		? NULL
+		: file_view(
+			&state->file,
+			index,
+			state->header.ptr_size * 3,
+			buffer
+		);
+
+	if(mem == NULL) {
+		return DBLL_ERR;
+	}
+
+	state->header.codec->empty_get(mem, slot);
+	return DBLL_OK;
+}
+
+static inline int data_slot_read(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state,
+	dbll_ptr_t ptr
+) {
+	dbll_index_t index = state_index(state, ptr);
+	if(
+		index < 0 ||
+		index_ptr_read(state, index, &slot->next_ptr) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	slot->data_index = index + state->header.ptr_size;
+	slot->this_ptr = ptr;
+	return DBLL_OK;
+}
+
+int dbll_list_valid(dbll_list_t *list) {
+	return (
+		DBLL_VALID(list != NULL) &&
+		DBLL_VALID(list->data_size >= 0) &&
+		DBLL_VALID(
+			list->data_kind == DBLL_DATA_CHAIN ||
+			list->data_kind == DBLL_DATA_EXTENT ||
+			list->data_kind == DBLL_DATA_CLASS ||
+			list->data_kind == DBLL_DATA_INLINE
+		) &&
+		DBLL_VALID(
+			(
+				list->head_ptr != list->this_ptr &&
+				list->tail_ptr != list->this_ptr &&
+				list->data_ptr != list->this_ptr
+			) || list->this_ptr == DBLL_NULL
+		)
+	);
+}
+
+int dbll_list_load(
+	dbll_list_t *list, 
+	dbll_state_t *state, 
+	dbll_ptr_t ptr
+) {
+	if(!dbll_state_valid(state) || !dbll_list_valid(list)) {
+		return DBLL_ERR;
+	}
+
+	if(list_read(list, state, ptr) < 0) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+// only the pointer gets checked, see dbll_list_go_unchecked
+int dbll_list_load_unchecked(
+	dbll_list_t *list, 
+	dbll_state_t *state, 
+	dbll_ptr_t ptr
+) {
+	if(list_read(list, state, ptr) < 0) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_list_unload(dbll_list_t *list) {
+	if(list == NULL) {
+		return DBLL_ERR;
+	}
+	
+	list->head_ptr = DBLL_NULL;
+	list->tail_ptr = DBLL_NULL;
+	list->data_ptr = DBLL_NULL;
+	list->data_size = 0;
+	list->data_kind = DBLL_DATA_CHAIN;
+	memset(list->data_inline, 0, sizeof(list->data_inline));
+	list->data_tail_ptr = DBLL_NULL;
+	list->data_generation = 0;
+	return DBLL_OK;
+}
+
+int dbll_list_go(
+	dbll_list_t *list, 
+	dbll_state_t *state, 
+	list_go_e go
+) {
+	if(
+		!dbll_list_valid(list) ||
+		!dbll_state_valid(state)
+	) {
+		return DBLL_ERR;
+	}
+	
+	dbll_ptr_t go_ptr = 0;
+	switch(go) {
+		case DBLL_GO_HEAD: {
+			go_ptr = list->head_ptr;
+			break;
+		}
+		
+		case DBLL_GO_TAIL: {
+			go_ptr = list->tail_ptr;
+			break;
+		}
+		
+		default: {
+			return DBLL_ERR;
+		}
+	}
+	
+	if(list_read(list, state, go_ptr) < 0) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_list_go_unchecked(
+	dbll_list_t *list, 
+	dbll_state_t *state, 
+	list_go_e go
+) {
+	dbll_ptr_t go_ptr = go == DBLL_GO_HEAD
+		? list->head_ptr
+		: list->tail_ptr;
+
+	if(list_read(list, state, go_ptr) < 0) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+dbll_index_t dbll_list_data_index(
+	dbll_list_t *list, 
+	dbll_state_t *state
+) {
+	if(
+		!dbll_list_valid(list) ||
+		!dbll_state_valid(state)
+	) {
+		return -1;
+	}
+	
+	return state_index(state, list->data_ptr);
+}
+
+int dbll_list_write(
+	dbll_list_t *list,
+	dbll_state_t *state
+) {
+	if(
+		!dbll_list_valid(list) ||
+		!dbll_state_valid(state) ||
+		!state_writable(state)
+	) {
+		return DBLL_ERR;
+	}
+
+	// older files have nowhere to keep the kind
+	if(
+		list->data_size > list_data_max(state) ||
+		(
+			list->data_kind != DBLL_DATA_CHAIN &&
+			state->header.version < 2
+		) || (
+			list->data_kind == DBLL_DATA_INLINE &&
+			list->data_size > list_inline_max(state)
+		)
+	) {
+		return DBLL_ERR;
+	}
+
+	// the other way around from dbll_list_inline_get
+	dbll_list_t encoded = *list;
+	int ptr_size = state->header.ptr_size;
+	int kind_shift = state->header.kind_shift;
+	if(list->data_kind == DBLL_DATA_INLINE) {
+		encoded.data_ptr = 0;
+		encoded.data_size = list->data_size << (kind_shift - 6);
+		for(int i = 0; i < ptr_size; i++) {
+			encoded.data_ptr |= (uint64_t)(list->data_inline[i]) << (i * 8);
+		}
+
+		for(int i = 0; i < state->header.data_size - 1; i++) {
+			encoded.data_size |= (
+				(dbll_size_t)(list->data_inline[ptr_size + i]) << 
+				(i * 8)
+			);
+		}
+	}
+
+	encoded.data_size |= (uint64_t)(list->data_kind) << kind_shift;
+
+	dbll_index_t index = state_index(state, list->this_ptr);
+	uint8_t mem[DBLL_PTR_MAX * 3 + DBLL_SIZE_MAX] = { 0 };
+	state->header.codec->list_put(mem, &encoded);
+	if(
+		index == -1 ||
+		state_write(
+			state,
+			index,
+			mem,
+			state->header.list_size
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+// adds a pointer to a growable array of pointers
+static int ptr_push(
+	dbll_ptr_t **ptrs,
+	dbll_index_t *size,
+	dbll_index_t *capacity,
+	dbll_ptr_t ptr
+) {
+	if(*size >= *capacity) {
+		dbll_index_t new_capacity = *capacity > 0
+			? *capacity * 2
+			: 64;
+
+		dbll_ptr_t *new_ptrs = realloc(
+			*ptrs, 
+			new_capacity * sizeof(dbll_ptr_t)
+		);
+
+		if(new_ptrs == NULL) {
+			return DBLL_ERR;
+		}
+
+		*ptrs = new_ptrs;
+		*capacity = new_capacity;
+	}
+
+	(*ptrs)[*size] = ptr;
+	(*size)++;
+	return DBLL_OK;
+}
+
+// goes through the subtree one level at a time, every level is
+// advised in one go before any of it is read, that way the reads
+// for a whole level happen at the same time instead of one page
+// fault after another. a negative depth goes through everything
+int dbll_list_prefetch(
+	dbll_list_t *list,
+	dbll_state_t *state,
+	dbll_index_t depth
+) {
+	if(
+		!dbll_list_valid(list) ||
+		!dbll_state_valid(state)
+	) {
+		return DBLL_ERR;
+	}
+
+	dbll_ptr_t *level = NULL;
+	dbll_index_t level_size = 0;
+	dbll_index_t level_capacity = 0;
+	dbll_ptr_t *next_level = NULL;
+	dbll_index_t next_level_size = 0;
+	dbll_index_t next_level_capacity = 0;
+	if(
+		(
+			list->head_ptr != DBLL_NULL &&
+			ptr_push(
+				&level, 
+				&level_size, 
+				&level_capacity, 
+				list->head_ptr
+			) < 0
+		) || (
+			list->tail_ptr != DBLL_NULL &&
+			ptr_push(
+				&level, 
+				&level_size, 
+				&level_capacity, 
+				list->tail_ptr
+			) < 0
+		)
+	) {
+		free(level);
+		return DBLL_ERR;
+	}
+
+	// trees shouldn't have cycles, but if one does this
+	// makes sure it doesn't go on forever
+	dbll_ptr_t visit_count = 0;
+	int result = DBLL_OK;
+	while(
+		level_size > 0 &&
+		depth != 0 &&
+		visit_count <= state->header.block_count
+	) {
+		if(dbll_state_fetch(state, level, level_size) < 0) {
+			result = DBLL_ERR;
+			break;
+		}
+
+		next_level_size = 0;
+		for(dbll_index_t i = 0; i < level_size && result >= 0; i++) {
+			dbll_list_t child = { 0 };
+			if(list_read(&child, state, level[i]) < 0) {
+				result = DBLL_ERR;
+				break;
+			}
+
+			visit_count++;
+			// all of an extent or class slot is right there, a
+			// chain only has its first block where it's known
+			if(child.data_ptr != DBLL_NULL) {
+				file_advise_range(
+					&state->file,
+					state_index(state, child.data_ptr),
+					child.data_kind != DBLL_DATA_CHAIN
+						? child.data_size
+						: state->header.list_size,
+					DBLL_ADVISE_WILLNEED
+				);
+			}
+
+			if(
+				(
+					child.head_ptr != DBLL_NULL &&
+					ptr_push(
+						&next_level,
+						&next_level_size,
+						&next_level_capacity,
+						child.head_ptr
+					) < 0
+				) || (
+					child.tail_ptr != DBLL_NULL &&
+					ptr_push(
+						&next_level,
+						&next_level_size,
+						&next_level_capacity,
+						child.tail_ptr
+					) < 0
+				)
+			) {
+				result = DBLL_ERR;
+			}
+		}
+
+		if(result < 0) {
+			break;
+		}
+
+		// the next level becomes the current one, the old
+		// current one gets reused for the level after that
+		dbll_ptr_t *temp_level = level;
+		dbll_index_t temp_capacity = level_capacity;
+		level = next_level;
+		level_size = next_level_size;
+		level_capacity = next_level_capacity;
+		next_level = temp_level;
+		next_level_capacity = temp_capacity;
+		depth--;
+	}
+
+	free(level);
+	free(next_level);
+	if(result < 0) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_empty_slot_valid(dbll_empty_slot_t *empty_slot) {
+	return (
+		DBLL_VALID(empty_slot != NULL) && (
+			DBLL_VALID(
+				(
+					empty_slot->prev_ptr != empty_slot->this_ptr &&
+					empty_slot->next_ptr != empty_slot->this_ptr
+				) || empty_slot->this_ptr == DBLL_NULL
+			)
+		)
+	);
+}
+
+int dbll_empty_slot_valid_ptr(
+	dbll_state_t *state,
+	dbll_ptr_t ptr
+) {
+	if(!dbll_state_valid(state)) {
+
+		// return 0 and not DBLL_ERR since an empty slot can't
+		// exist if a state for it doesn't exist either
+		return 0;
+	}
+
+	dbll_index_t index = state_index(state, ptr);
+	if(index == -1) {
+
+		// see comment above
+		return 0;
+	}
+
+	dbll_ptr_t maybe_this_ptr = DBLL_NULL;
+	if(
+		index_ptr_read(
+			state,
+			index,
+			&maybe_this_ptr
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	// the reason that this works is my intentionally designing
+	// constraints around referencing one's self in data, nothing
+	// can do this except an empty slot. this is done so that dbll_state_trim
+	// doesn't have to run through the entire empty slot linked list in order
+	// to find what it wants. basically an optimization technique
+	if(maybe_this_ptr != ptr) {
+		return 0;
+	}
+
+	// except for extents, their blocks are whatever the user put in
+	// them. so the slots on either side have to point back at this
+	// one too, and a slot on its own has to be the only one there is
+	dbll_empty_slot_t slot = { 0 };
+	dbll_empty_slot_t other_slot = { 0 };
+	if(empty_slot_read(&slot, state, ptr) < 0) {
+		return 0;
+	}
+
+	if(slot.prev_ptr == DBLL_NULL && slot.next_ptr == DBLL_NULL) {
+		return (
+			ptr == state->last_empty.this_ptr ||
+			ptr == state->header.empty_slot_ptr
+		);
+	}
+
+	return (
+		(
+			slot.prev_ptr == DBLL_NULL || (
+				empty_slot_read(&other_slot, state, slot.prev_ptr) >= 0 &&
+				other_slot.next_ptr == ptr
+			)
+		) && (
+			slot.next_ptr == DBLL_NULL || (
+				empty_slot_read(&other_slot, state, slot.next_ptr) >= 0 &&
+				other_slot.prev_ptr == ptr
+			)
+		)
+	);
+}
+
+int dbll_empty_slot_load(
+	dbll_empty_slot_t *empty_slot,
+	dbll_state_t *state,
+	dbll_ptr_t list_ptr
+) {
+	if(
+		!dbll_state_valid(state) || 
+		empty_slot == NULL ||
+		empty_slot_read(empty_slot, state, list_ptr) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_empty_slot_unload(dbll_empty_slot_t *slot) {
+	if(slot == NULL) {
+		return DBLL_ERR;
+	}
+
+	slot->this_ptr = DBLL_NULL;
+	slot->prev_ptr = DBLL_NULL;
+	slot->next_ptr = DBLL_NULL;
+	return DBLL_OK;
+}
+
+int dbll_empty_slot_write(
+	dbll_empty_slot_t *slot, 
+	dbll_state_t *state
+) {
+	if(
+		!dbll_empty_slot_valid(slot) ||
+		!dbll_state_valid(state) ||
+		!state_writable(state)
+	) {
+		return DBLL_ERR;
+	}
+
+	dbll_index_t index = state_index(state, slot->this_ptr);
+	uint8_t mem[DBLL_PTR_MAX * 3] = { 0 };
+	state->header.codec->empty_put(mem, slot);
+	if(
+		index == -1 ||
+		state_write(
+			state,
+			index,
+			mem,
+			state->header.ptr_size * 3
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_empty_slot_clip(
+	dbll_empty_slot_t *slot,
+	dbll_state_t *state
+) {
+	if(
+		!dbll_empty_slot_valid(slot) ||
+		!dbll_state_valid(state) ||
+		!state_writable(state)
+	) {
+		return DBLL_ERR;
+	}
+
+	if(
+		slot->prev_ptr == DBLL_NULL &&
+		slot->next_ptr == DBLL_NULL &&
+		state->last_empty.this_ptr == slot->this_ptr &&
+		dbll_empty_slot_unload(&state->last_empty) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	// loaded into a copy first, the state has to stay valid
+	// while the slot is being loaded
+	if(
+		slot->prev_ptr != DBLL_NULL &&
+		slot->next_ptr == DBLL_NULL &&
+		state->last_empty.this_ptr == slot->this_ptr
+	) {
+		dbll_empty_slot_t new_last = { 0 };
+		if(
+			empty_slot_read(
+				&new_last,
+				state,
+				slot->prev_ptr
+			) < 0
+		) {
+			return DBLL_ERR;
+		}
+
+		new_last.next_ptr = DBLL_NULL;
+		state->last_empty = new_last;
+	}
+
+	if(slot->prev_ptr == DBLL_NULL) {
+		state->header.first_empty_ptr = slot->next_ptr;
+	}
+
+	if(slot->prev_ptr != DBLL_NULL) {
+		dbll_empty_slot_t prev_slot = { 0 };
+		if(
+			empty_slot_read(
+				&prev_slot, 
+				state,
+				slot->prev_ptr
+			) < 0
+		) {
+			return DBLL_ERR;
+		}
+
+		prev_slot.next_ptr = slot->next_ptr;
+		dbll_empty_slot_write(&prev_slot, state);
+	}
+
+	if(slot->next_ptr != DBLL_NULL) {
+		dbll_empty_slot_t next_slot = { 0 };
+		if(
+			empty_slot_read(
+				&next_slot,
+				state,
+				slot->next_ptr
+			) < 0
+		) {
+			return DBLL_ERR;
+		}
+
+		next_slot.prev_ptr = slot->prev_ptr;
+		dbll_empty_slot_write(&next_slot, state);
+	}
+
+	if(dbll_empty_slot_unload(slot) < 0) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+// data slot chains are walked one block at a time, never recursively,
+// since a chain can be millions of blocks long. they can also come
+// back around on themselves, so where one ends is found with brent's
+// algorithm, which only keeps two pointers no matter how long it is
+static int chain_next(
+	dbll_state_t *state,
+	dbll_ptr_t ptr,
+	dbll_ptr_t *next_ptr
+) {
+	dbll_index_t index = state_index(state, ptr);
+	if(index < 0 || index_ptr_read(state, index, next_ptr) < 0) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+// count is how many different blocks the chain starting at first_ptr
+// goes through, last_ptr is the last of those, the one that points to
+// null or back to one before it
+static int chain_end(
+	dbll_state_t *state,
+	dbll_ptr_t first_ptr,
+	dbll_ptr_t *last_ptr,
+	dbll_index_t *count
+) {
+	// the hare goes ahead a block at a time, and the tortoise jumps
+	// to it whenever the hare has gone a power of two past it. in a
+	// cycle the hare lands on the tortoise within two laps, and how
+	// far it went since the last jump is the length of the cycle
+	dbll_ptr_t tortoise = first_ptr;
+	dbll_ptr_t hare = first_ptr;
+	dbll_ptr_t prev_ptr = DBLL_NULL;
+	dbll_index_t power = 1;
+	dbll_index_t cycle_size = 0;
+	dbll_index_t hare_count = 0;
+	do {
+		if(cycle_size == power) {
+			tortoise = hare;
+			power *= 2;
+			cycle_size = 0;
+		}
+
+		prev_ptr = hare;
+		if(chain_next(state, hare, &hare) < 0) {
+			return DBLL_ERR;
+		}
+
+		cycle_size++;
+		hare_count++;
+	} while(hare != DBLL_NULL && hare != tortoise);
+
+	if(hare == DBLL_NULL) {
+		if(last_ptr != NULL) {
+			*last_ptr = prev_ptr;
+		}
+
+		*count = hare_count;
+		return DBLL_OK;
+	}
+
+	// the hare starts a cycle ahead of the tortoise this time, they
+	// meet where the cycle starts, and the hare comes from the last
+	// block before it comes around
+	tortoise = first_ptr;
+	hare = first_ptr;
+	for(dbll_index_t i = 0; i < cycle_size; i++) {
+		prev_ptr = hare;
+		if(chain_next(state, hare, &hare) < 0) {
+			return DBLL_ERR;
+		}
+	}
+
+	dbll_index_t tail_size = 0;
+	while(tortoise != hare) {
+		prev_ptr = hare;
+		if(
+			chain_next(state, tortoise, &tortoise) < 0 ||
+			chain_next(state, hare, &hare) < 0
+		) {
+			return DBLL_ERR;
+		}
+
+		tail_size++;
+	}
+
+	if(last_ptr != NULL) {
+		*last_ptr = prev_ptr;
+	}
+
+	*count = tail_size + cycle_size;
+	return DBLL_OK;
+}
+
+// frees count blocks of the chain starting at ptr. the next pointer
+// has to be read before the block is freed, that writes over it
+static int chain_free(
+	dbll_state_t *state,
+	dbll_ptr_t ptr,
+	dbll_index_t count
+) {
+	for(dbll_index_t i = 0; i < count; i++) {
+		dbll_ptr_t next_ptr = DBLL_NULL;
+		if(
+			chain_next(state, ptr, &next_ptr) < 0 ||
+			dbll_state_mark_free(state, ptr) < 0
+		) {
+			return DBLL_ERR;
+		}
+
+		ptr = next_ptr;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_data_slot_valid(dbll_data_slot_t *slot) {
+	return (
+		DBLL_VALID(slot != NULL) &&
+		DBLL_VALID(slot->data_index >= 0) &&
+		DBLL_VALID(slot->this_ptr != DBLL_NULL) && DBLL_VALID(
+			slot->next_ptr != slot->this_ptr || (
+				slot->next_ptr == DBLL_NULL &&
+				slot->this_ptr == DBLL_NULL
+			)
+		)
+	);
+}
+
+int dbll_data_slot_load(
+	dbll_data_slot_t *slot, 
+	dbll_state_t *state, 
+	dbll_ptr_t ptr
+) {
+	if(
+		!dbll_state_valid(state) || 
+		slot == NULL ||
+		data_slot_read(slot, state, ptr) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_data_slot_unload(dbll_data_slot_t *slot) {
+	if(slot == NULL) {
+		return DBLL_ERR;
+	}
+
+	slot->next_ptr = DBLL_NULL;
+	slot->data_index = 0;
+	slot->this_ptr = DBLL_NULL;
+	slot->table = NULL;
+	return DBLL_OK;
+}
+
+int dbll_data_slot_next(
+	dbll_data_slot_t *slot, 
+	dbll_state_t *state
+) {
+	if(
+		!dbll_data_slot_valid(slot) ||
+		!dbll_state_valid(state) ||
+		slot->next_ptr == DBLL_NULL
+	) {
+		return DBLL_ERR;
+	}
+
+	if(
+		data_slot_read(
+			slot,
+			state,
+			slot->next_ptr
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_data_slot_free(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state
+) {
+	if(
+		!dbll_data_slot_valid(slot) ||
+		!dbll_state_valid(state) ||
+		!state_writable(state)
+	) {
+		return DBLL_ERR;
+	}
+
+	dbll_index_t count = 0;
+	if(
+		chain_end(state, slot->this_ptr, NULL, &count) < 0 ||
+		chain_free(state, slot->this_ptr, count) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	dbll_data_slot_unload(slot);
+	return DBLL_OK;
+}
+
+// loads the page page_number pages after slot into page. without a page
+// table that's walking the chain, with one it's an array lookup once the
+// table has gotten that far. the table goes through next pointers the
+// same way, so a cyclic chain just keeps going around
+static int data_slot_seek(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state,
+	dbll_index_t page_number,
+	dbll_data_slot_t *page
+) {
+	dbll_page_table_t *table = slot->table;
+	if(table == NULL) {
+		*page = *slot;
+		for(dbll_index_t i = 0; i < page_number; i++) {
+			if(data_slot_read(page, state, page->next_ptr) < 0) {
+				return DBLL_ERR;
+			}
+		}
+
+		return DBLL_OK;
+	}
+
+	if(
+		table->count == 0 ||
+		table->generation != state->generation ||
+		table->ptrs[0] != slot->this_ptr
+	) {
+		table->count = 0;
+		table->generation = state->generation;
+	}
+
+	while(table->count <= page_number) {
+		if(table->count == table->capacity) {
+			dbll_index_t capacity = table->capacity == 0
+				? 16
+				: table->capacity * 2;
+
+			dbll_ptr_t *ptrs = realloc(
+				table->ptrs, 
+				capacity * sizeof(dbll_ptr_t)
+			);
+
+			if(ptrs == NULL) {
+				return DBLL_ERR;
+			}
+
+			table->ptrs = ptrs;
+			table->capacity = capacity;
+		}
+
+		dbll_ptr_t ptr = slot->this_ptr;
+		if(
+			table->count > 0 &&
+			chain_next(state, table->ptrs[table->count - 1], &ptr) < 0
+		) {
+			return DBLL_ERR;
+		}
+
+		if(ptr == DBLL_NULL) {
 			return DBLL_ERR;
 		}
+
+		table->ptrs[table->count] = ptr;
+		table->count++;
+	}
+
+	page->table = NULL;
+	if(data_slot_read(page, state, table->ptrs[page_number]) < 0) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+// doesn't prevent cyclic data slot access
+// in order to make circular memory possible
+dbll_index_t dbll_data_slot_page(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state,
+	dbll_index_t user_index
+) {
+	if(
+		!dbll_data_slot_valid(slot) ||
+		!dbll_state_valid(state) ||
+		user_index < 0
+	) {
+		return -1;
 	}
 	
+	dbll_index_t page_number = user_index / state->header.data_slot_size;
+	dbll_index_t page_offset = user_index % state->header.data_slot_size;
+	dbll_data_slot_t page = { 0 };
+	if(data_slot_seek(slot, state, page_number, &page) < 0) {
+		return -1;
+	}
+
+	return page.data_index + page_offset;
+}
+
+int dbll_page_table_load(
+	dbll_page_table_t *table, 
+	dbll_data_slot_t *slot
+) {
+	if(table == NULL || slot == NULL) {
+		return DBLL_ERR;
+	}
+
+	*table = (dbll_page_table_t) { 0 };
+	slot->table = table;
+	return DBLL_OK;
+}
+
+int dbll_page_table_unload(dbll_page_table_t *table) {
+	if(table == NULL) {
+		return DBLL_ERR;
+	}
+
+	free(table->ptrs);
+	*table = (dbll_page_table_t) { 0 };
+	return DBLL_OK;
+}
+
+int dbll_data_slot_resize(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state,
+	dbll_index_t size
+) {
 	if(
-		dbll_list_load(
-			list,
+		!dbll_data_slot_valid(slot) ||
+		!dbll_state_valid(state) ||
+		!state_writable(state)
+	) {
+		return DBLL_ERR;
+	}
+
+	if(size == 0) {
+
+		// nothing to allocate but shouldn't error
+		return DBLL_OK;
+	}
+
+	if(size < 0) {
+		if(
+			dbll_data_slot_cut_end(
+				slot,
+				state,
+				-size
+			) < 0
+		) {
+			return DBLL_ERR;
+		}
+
+		return DBLL_OK;
+	}
+
+	dbll_ptr_t last_ptr = dbll_data_slot_last(
+		slot,
+		state,
+		NULL
+	);
+
+	if(last_ptr == DBLL_NULL) {
+		return DBLL_ERR;
+	}
+
+	dbll_data_slot_t last_slot = { 0 };
+	if(
+		data_slot_read(
+			&last_slot,
+			state,
+			last_ptr
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	if(
+		dbll_data_slot_alloc(
+			&last_slot,
 			state,
-			go_ptr
+			size
 		) < 0
 	) {
 		return DBLL_ERR;
 	}
 
+	if(last_slot.this_ptr == slot->this_ptr) {
+		slot->next_ptr = last_slot.next_ptr;
+	}
+
 	return DBLL_OK;
 }
 
-int dbll_list_data_index(
-	dbll_list_t *list, 
+// undoes a data_slot_append that failed part way. slot points at end_ptr
+// again, and the count blocks it had linked in from first_ptr on are
+// freed along with the rest_count blocks in rest that weren't linked
+// yet. errors are ignored here, the append has failed already
+static void data_slot_unlink(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state,
+	dbll_ptr_t end_ptr,
+	dbll_ptr_t first_ptr,
+	dbll_index_t count,
+	dbll_ptr_t *rest,
+	dbll_index_t rest_count
+) {
+	if(count > 0) {
+		slot->next_ptr = end_ptr;
+		index_ptr_write(state, state_index(state, slot->this_ptr), end_ptr);
+		chain_free(state, first_ptr, count);
+	}
+
+	for(dbll_index_t i = 0; i < rest_count; i++) {
+		dbll_state_mark_free(state, rest[i]);
+	}
+}
+
+// puts count new blocks in the chain right after slot, last_ptr is
+// the last of them. whatever slot pointed to comes after that, so a
+// cycle through slot stays a cycle. if it fails the chain is left the
+// way it was
+static int data_slot_append(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state,
+	dbll_index_t count,
+	dbll_ptr_t *last_ptr
+) {
+	if(count == 0) {
+		if(last_ptr != NULL) {
+			*last_ptr = slot->this_ptr;
+		}
+
+		return DBLL_OK;
+	}
+
+	// the blocks come from dbll_state_alloc_n a batch at a time, and
+	// each one's next pointer is written straight in. the state was
+	// checked by whatever called this
+	dbll_ptr_t ptrs[DBLL_ALLOC_BATCH] = { 0 };
+	dbll_ptr_t end_ptr = slot->next_ptr;
+	dbll_ptr_t first_ptr = DBLL_NULL;
+	dbll_ptr_t prev_ptr = slot->this_ptr;
+	dbll_index_t linked_count = 0;
+	while(linked_count < count) {
+		dbll_index_t batch = count - linked_count;
+		if(batch > DBLL_ALLOC_BATCH) {
+			batch = DBLL_ALLOC_BATCH;
+		}
+
+		if(
+			dbll_state_alloc_n(
+				state, 
+				batch, 
+				ptrs, 
+				DBLL_ALLOC_DEFAULT
+			) < 0
+		) {
+			data_slot_unlink(
+				slot, 
+				state, 
+				end_ptr, 
+				first_ptr, 
+				linked_count, 
+				NULL, 
+				0
+			);
+
+			return DBLL_ERR;
+		}
+
+		for(dbll_index_t i = 0; i < batch; i++) {
+			if(
+				index_ptr_write(
+					state, 
+					state_index(state, prev_ptr), 
+					ptrs[i]
+				) < 0
+			) {
+				data_slot_unlink(
+					slot, 
+					state, 
+					end_ptr, 
+					first_ptr, 
+					linked_count, 
+					ptrs + i, 
+					batch - i
+				);
+
+				return DBLL_ERR;
+			}
+
+			if(linked_count == 0) {
+				first_ptr = ptrs[0];
+				slot->next_ptr = first_ptr;
+			}
+
+			prev_ptr = ptrs[i];
+			linked_count++;
+		}
+	}
+
+	// the chain changed shape, like dbll_data_slot_write would say
+	state->generation++;
+	if(
+		index_ptr_write(
+			state, 
+			state_index(state, prev_ptr), 
+			end_ptr
+		) < 0
+	) {
+		data_slot_unlink(
+			slot, 
+			state, 
+			end_ptr, 
+			first_ptr, 
+			linked_count, 
+			NULL, 
+			0
+		);
+
+		return DBLL_ERR;
+	}
+
+	if(last_ptr != NULL) {
+		*last_ptr = prev_ptr;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_data_slot_alloc(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state,
+	dbll_index_t size
+) {
+	if(
+		!dbll_data_slot_valid(slot) ||
+		!dbll_state_valid(state) ||
+		!state_writable(state) ||
+		size < 0 ||
+		data_slot_append(slot, state, size, NULL) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_data_slot_write(
+	dbll_data_slot_t *slot,
 	dbll_state_t *state
 ) {
 	if(
-		!dbll_list_valid(list) ||
-		!dbll_state_valid(state)
+		!dbll_data_slot_valid(slot) ||
+		!dbll_state_valid(state) ||
+		!state_writable(state)
 	) {
-		return -1;
+		return DBLL_ERR;
+	}
+
+	dbll_index_t index = state_index(
+		state,
+		slot->this_ptr
+	);
+
+	if(index == -1) {
+		return DBLL_ERR;
+	}
+
+	// the chain might not go the same way anymore
+	state->generation++;
+	if(
+		dbll_ptr_index_copy(
+			state,
+			slot->next_ptr,
+			index
+		) < 0
+	) {
+		return DBLL_ERR;
 	}
-	
-	return dbll_ptr_to_index(state, list->data_ptr);
+
+	return DBLL_OK;
 }
 
-int dbll_list_data_alloc(
-	dbll_list_t *list,
+int dbll_data_slot_cut_end(
+	dbll_data_slot_t *slot,
 	dbll_state_t *state,
-	int size
+	dbll_index_t size
 ) {
 	if(
-		!dbll_list_valid(list) ||
+		!dbll_data_slot_valid(slot) ||
 		!dbll_state_valid(state) ||
-		list->data_ptr != DBLL_NULL ||
+		!state_writable(state) ||
 		size < 0
 	) {
 		return DBLL_ERR;
 	}
 
-	dbll_data_slot_t slot = { 0 };
-	dbll_ptr_t tail_ptr = dbll_state_alloc(state);
-	if(tail_ptr == DBLL_NULL) {
-		return DBLL_ERR;
+	if(size == 0) {
+		return DBLL_OK;
 	}
 
+	// the first block stays, whatever points to the data points there
+	dbll_index_t count = 0;
 	if(
-		dbll_data_slot_load(
-			&slot,
-			state,
-			tail_ptr
-		) < 0
+		chain_end(state, slot->this_ptr, NULL, &count) < 0 ||
+		size >= count
 	) {
 		return DBLL_ERR;
 	}
 
-	if(dbll_data_slot_alloc(&slot, state, size) < 0) {
-		return DBLL_ERR;
+	// the new last block gets disconnected first, so the blocks after
+	// it can be freed even if the last one of them points back before
+	dbll_data_slot_t last_slot = *slot;
+	for(dbll_index_t i = 0; i < count - size - 1; i++) {
+		if(data_slot_read(&last_slot, state, last_slot.next_ptr) < 0) {
+			return DBLL_ERR;
+		}
 	}
 
-	list->data_ptr = slot.this_ptr;
-	list->data_size = size;
+	dbll_ptr_t cut_ptr = last_slot.next_ptr;
+	last_slot.next_ptr = DBLL_NULL;
 	if(
-		dbll_list_write(
-			list,
-			state
-		) < 0
+		dbll_data_slot_write(&last_slot, state) < 0 ||
+		chain_free(state, cut_ptr, size) < 0
 	) {
 		return DBLL_ERR;
 	}
 
+	if(last_slot.this_ptr == slot->this_ptr) {
+		slot->next_ptr = DBLL_NULL;
+	}
+
 	return DBLL_OK;
 }
 
-int dbll_list_data_resize(
-	dbll_list_t *list, 
-	dbll_state_t *state, 
-	int size
+dbll_ptr_t dbll_data_slot_last(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state,
+	dbll_index_t *size
 ) {
 	if(
-		!dbll_list_valid(list) ||
+		!dbll_data_slot_valid(slot) ||
 		!dbll_state_valid(state)
+	) {
+		return DBLL_NULL_ERR;
+	}
+
+	dbll_ptr_t last_ptr = DBLL_NULL;
+	dbll_index_t count = 0;
+	if(chain_end(state, slot->this_ptr, &last_ptr, &count) < 0) {
+		return DBLL_NULL_ERR;
+	}
+
+	// counts the blocks after this one, like it always has
+	if(size != NULL) {
+		*size += count - 1;
+	}
+
+	return last_ptr;
+}
+
+// copies between mem and the data in the chain, starting offset bytes
+// into it. every block's data is copied in one go, so it's one read or
+// write per block instead of one per byte
+static int data_slot_write_read(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state,
+	dbll_index_t offset,
+	uint8_t *mem,
+	dbll_index_t mem_size,
+	int is_write
+) {
+	if(
+		!dbll_data_slot_valid(slot) ||
+		!dbll_state_valid(state) ||
+		(is_write && !state_writable(state)) ||
+		offset < 0 ||
+		mem == NULL ||
+		mem_size < 0
 	) {
 		return DBLL_ERR;
 	}
 
-	if(list->data_ptr == DBLL_NULL) {
-		if(size < 0) {
+	if(mem_size == 0) {
+		return DBLL_OK;
+	}
+
+	int page_size = state->header.data_slot_size;
+	dbll_data_slot_t page = { 0 };
+	if(data_slot_seek(slot, state, offset / page_size, &page) < 0) {
+		return DBLL_ERR;
+	}
+
+	dbll_index_t page_offset = offset % page_size;
+	while(1) {
+		dbll_index_t span = page_size - page_offset;
+		if(span > mem_size) {
+			span = mem_size;
+		}
+
+		dbll_index_t index = page.data_index + page_offset;
+		if(is_write) {
+			if(state_write(state, index, mem, span) < 0) {
+				return DBLL_ERR;
+			}
+		} else if(dbll_file_read(&state->file, index, mem, span) < 0) {
 			return DBLL_ERR;
 		}
 
-		if(size == 0) {
+		mem += span;
+		mem_size -= span;
+		if(mem_size == 0) {
 			return DBLL_OK;
 		}
-		
-		if(
-			dbll_list_data_alloc(
-				list,
-				state,
-				size
-			) < 0
-		) {
+
+		page_offset = 0;
+		if(data_slot_read(&page, state, page.next_ptr) < 0) {
 			return DBLL_ERR;
 		}
-
-		return DBLL_OK;
 	}
+}
 
-	// need first slot to feed in dbll_data_slot_last in order
-	// to get last slot
-	dbll_data_slot_t slot = { 0 };
+int dbll_data_slot_write_mem(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state,
+	dbll_index_t offset,
+	uint8_t *mem,
+	dbll_index_t mem_size
+) {
 	if(
-		dbll_data_slot_load(
-			&slot, 
-			state, 
-			list->data_ptr
+		data_slot_write_read(
+			slot,
+			state,
+			offset,
+			mem,
+			mem_size,
+			1
 		) < 0
 	) {
 		return DBLL_ERR;
 	}
 
+	return DBLL_OK;
+}
+
+int dbll_data_slot_read_mem(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state,
+	dbll_index_t offset,
+	uint8_t *mem,
+	dbll_index_t mem_size
+) {
 	if(
-		dbll_data_slot_resize(
-			&slot,
+		data_slot_write_read(
+			slot,
 			state,
-			size
+			offset,
+			mem,
+			mem_size,
+			0
 		) < 0
 	) {
 		return DBLL_ERR;
@@ -575,632 +3451,842 @@ int dbll_list_data_resize(
 	return DBLL_OK;
 }
 
-int dbll_list_write(
-	dbll_list_t *list,
-	dbll_state_t *state
+// points iovs at the data in the chain instead of copying it out. each
+// block's part is one span, and spans that end where the next one starts
+// are merged. it stops after max spans, returns how many it used
+int dbll_data_slot_iov(
+	dbll_data_slot_t *slot,
+	dbll_state_t *state,
+	dbll_index_t offset,
+	dbll_index_t size,
+	struct iovec *iovs,
+	int max
 ) {
 	if(
-		!dbll_list_valid(list) ||
-		!dbll_state_valid(state)
+		!dbll_data_slot_valid(slot) ||
+		!dbll_state_valid(state) ||
+
+		// pool pages can be evicted, there's nothing to point at
+		state->file.flags & DBLL_OPEN_POOL ||
+		offset < 0 ||
+		size < 0 ||
+		iovs == NULL ||
+		max < 0
 	) {
 		return DBLL_ERR;
 	}
 
-	int index = dbll_ptr_to_index(state, list->this_ptr);
-	int ptr_size = state->header.ptr_size;
-	if(
-		index == -1 ||
-		ptr_size <= 0 ||
-		dbll_ptr_index_copy(
-			state,
-			list->head_ptr,
-			index
-		) < 0 ||
+	if(size == 0 || max == 0) {
+		return 0;
+	}
 
-		dbll_ptr_index_copy(
-			state,
-			list->tail_ptr,
-			index + ptr_size
-		) < 0 ||
+	int page_size = state->header.data_slot_size;
+	dbll_data_slot_t page = { 0 };
+	if(data_slot_seek(slot, state, offset / page_size, &page) < 0) {
+		return DBLL_ERR;
+	}
 
-		dbll_ptr_index_copy(
-			state,
-			list->data_ptr,
-			index + (ptr_size * 2)
-		) < 0 ||
+	int count = 0;
+	dbll_index_t page_offset = offset % page_size;
+	while(1) {
+		dbll_index_t span = page_size - page_offset;
+		if(span > size) {
+			span = size;
+		}
 
-		dbll_size_index_copy(
-			state,
-			list->data_size,
-			index + (ptr_size * 3)
-		) < 0
-	) {
-		return DBLL_ERR;
+		uint8_t *mem = state->file.mem + page.data_index + page_offset;
+		if(
+			count > 0 &&
+			(uint8_t *)(iovs[count - 1].iov_base) + 
+				iovs[count - 1].iov_len == mem
+		) {
+			iovs[count - 1].iov_len += span;
+		} else if(count < max) {
+			iovs[count].iov_base = mem;
+			iovs[count].iov_len = span;
+			count++;
+		} else {
+			return count;
+		}
+
+		size -= span;
+		if(size == 0) {
+			return count;
+		}
+
+		page_offset = 0;
+		if(data_slot_read(&page, state, page.next_ptr) < 0) {
+			return DBLL_ERR;
+		}
 	}
+}
 
-	return DBLL_OK;
+// the list functions that change data come after the data slot ones,
+// they're built out of them
+// how many blocks it takes to hold size bytes of data
+static dbll_index_t list_data_blocks(
+	dbll_state_t *state, 
+	dbll_index_t size
+) {
+	int page_size = state->header.data_slot_size;
+	return (size + page_size - 1) / page_size;
 }
 
-int dbll_empty_slot_valid(dbll_empty_slot_t *empty_slot) {
-	return (
-		DBLL_VALID(empty_slot != NULL) && (
-			DBLL_VALID(
-				(
-					empty_slot->prev_ptr != empty_slot->this_ptr &&
-					empty_slot->next_ptr != empty_slot->this_ptr
-				) || empty_slot->this_ptr == DBLL_NULL
-			)
-		)
-	);
+// how many bytes of data the list has. version 0 files count the blocks
+// in the chain instead, all of every one of them is data there
+static dbll_index_t list_data_used(
+	dbll_list_t *list,
+	dbll_state_t *state
+) {
+	if(state->header.version < 2) {
+		return list->data_size * state->header.data_slot_size;
+	}
+
+	return list->data_size;
 }
 
-int dbll_empty_slot_valid_ptr(
+// the other way around, what goes in data_size for size bytes
+static dbll_index_t list_data_stored(
 	dbll_state_t *state,
-	dbll_ptr_t ptr
+	dbll_index_t size
 ) {
-	if(!dbll_state_valid(state)) {
-
-		// return 0 and not DBLL_ERR since an empty slot can't
-		// exist if a state for it doesn't exist either
-		return 0;
+	if(state->header.version < 2) {
+		return list_data_blocks(state, size);
 	}
 
-	int index = dbll_ptr_to_index(state, ptr);
-	if(index == -1) {
+	return size;
+}
 
-		// see comment above
-		return 0;
-	}
+// how many blocks a run takes to hold size bytes, there's nothing
+// else in them so all of a block is data
+static dbll_index_t list_run_blocks(
+	dbll_state_t *state, 
+	dbll_index_t size
+) {
+	int block_size = state->header.block_size;
+	return (size + block_size - 1) / block_size;
+}
 
-	dbll_ptr_t maybe_this_ptr = DBLL_NULL;
+// where an extent's or class slot's data starts in the file, or -1 if
+// the run goes past the last block
+static dbll_index_t list_run_index(
+	dbll_list_t *list,
+	dbll_state_t *state
+) {
+	dbll_index_t count = list_run_blocks(state, list->data_size);
 	if(
-		dbll_index_ptr_copy(
-			state,
-			index,
-			&maybe_this_ptr
-		) < 0
+		count == 0 ||
+		state_index(state, list->data_ptr + count - 1) < 0
 	) {
-		return DBLL_ERR;
+		return -1;
 	}
 
-	// the reason that this works is my intentionally designing
-	// constraints around referencing one's self in data, nothing
-	// can do this except an empty slot. this is done so that dbll_state_trim
-	// doesn't have to run through the entire empty slot linked list in order
-	// to find what it wants. basically an optimization technique
-	return maybe_this_ptr == ptr;
+	return state_index(state, list->data_ptr);
 }
 
-int dbll_empty_slot_load(
-	dbll_empty_slot_t *empty_slot,
+// zeroes count blocks from ptr on
+static int run_zero(
 	dbll_state_t *state,
-	dbll_ptr_t list_ptr
+	dbll_ptr_t ptr,
+	dbll_index_t count
+) {
+	uint8_t zero[DBLL_CACHE_LINE] = { 0 };
+	for(dbll_index_t i = 0; i < count; i++) {
+		if(
+			state_write(
+				state,
+				state_index(state, ptr + i),
+				zero,
+				state->header.block_size
+			) < 0
+		) {
+			return DBLL_ERR;
+		}
+	}
+
+	return DBLL_OK;
+}
+
+// frees a run from its last block to its first
+static int run_free(
+	dbll_state_t *state,
+	dbll_ptr_t ptr,
+	dbll_index_t count
 ) {
+	for(dbll_index_t i = count - 1; i >= 0; i--) {
+		if(dbll_state_mark_free(state, ptr + i) < 0) {
+			return DBLL_ERR;
+		}
+	}
+
+	return DBLL_OK;
+}
+
+// the smallest size class size bytes fit in, DBLL_CLASS_COUNT
+// if they don't fit in any
+static int list_data_class(dbll_state_t *state, dbll_index_t size) {
+	dbll_index_t count = list_run_blocks(state, size);
+	int class = 0;
+	while(
+		class < DBLL_CLASS_COUNT &&
+		((dbll_index_t)(1) << class) < count
+	) {
+		class++;
+	}
+
+	return class;
+}
+
+// where the first free slot of a class is kept. the class table
+// is a run of its own, made the first time any class is used
+static dbll_index_t class_head_index(dbll_state_t *state, int class) {
+	int ptr_size = state->header.ptr_size;
+	if(state->header.class_ptr == DBLL_NULL) {
+		dbll_ptr_t table_ptr = dbll_state_alloc_run(
+			state,
+			list_run_blocks(state, DBLL_CLASS_COUNT * ptr_size)
+		);
+
+		if(table_ptr == DBLL_NULL) {
+			return -1;
+		}
+
+		state->header.class_ptr = table_ptr;
+	}
+
+	dbll_index_t index = state_index(state, state->header.class_ptr);
+	if(index < 0) {
+		return -1;
+	}
+
+	return index + (class * ptr_size);
+}
+
+// takes the first slot off a class's free list, every free slot
+// starts with a pointer to the next one. when there aren't any
+// left a slab of them is made in one run, so slots of a class
+// are next to each other
+static dbll_ptr_t class_alloc(dbll_state_t *state, int class) {
+	dbll_ptr_t ptr = DBLL_NULL;
+	dbll_index_t head_index = class_head_index(state, class);
 	if(
-		!dbll_state_valid(state) || 
-		empty_slot == NULL ||
-		list_ptr == DBLL_NULL
+		head_index < 0 ||
+		index_ptr_read(state, head_index, &ptr) < 0
 	) {
-		return DBLL_ERR;
+		return DBLL_NULL_ERR;
 	}
 
-	int index = dbll_ptr_to_index(state, list_ptr);
-	int ptr_size = state->header.ptr_size;
-	if(
-		index == -1 ||
-		ptr_size <= 0 ||
-		dbll_index_ptr_copy(
-			state, 
-			index,
-			&empty_slot->prev_ptr
-		) < 0 ||
+	dbll_index_t slot_count = (dbll_index_t)(1) << class;
+	int is_slab = ptr == DBLL_NULL;
+	if(is_slab) {
+		dbll_index_t slab_count = DBLL_CLASS_SLAB / slot_count;
+		ptr = dbll_state_alloc_run(state, DBLL_CLASS_SLAB);
+		if(ptr == DBLL_NULL) {
+			return DBLL_NULL_ERR;
+		}
 
-		dbll_index_ptr_copy(
-			state, 
-			index + ptr_size,
-			&empty_slot->next_ptr
-		) < 0 ||
+		// the last slot is left pointing at nothing. until the head
+		// points at the slab it's on no list, so it's freed if
+		// anything goes wrong before then
+		for(dbll_index_t i = 0; i < slab_count - 1; i++) {
+			dbll_ptr_t slot_ptr = ptr + (i * slot_count);
+			if(
+				index_ptr_write(
+					state,
+					state_index(state, slot_ptr),
+					slot_ptr + slot_count
+				) < 0
+			) {
+				run_free(state, ptr, DBLL_CLASS_SLAB);
+				return DBLL_NULL_ERR;
+			}
+		}
+	}
 
-		dbll_index_ptr_copy(
-			state, 
-			index + (ptr_size * 2),
-			&empty_slot->this_ptr
-		) < 0
+	// a slot that was used before still has its old data in it
+	dbll_ptr_t next_ptr = DBLL_NULL;
+	if(
+		index_ptr_read(state, state_index(state, ptr), &next_ptr) < 0 ||
+		index_ptr_write(state, head_index, next_ptr) < 0
 	) {
-		return DBLL_ERR;
+		if(is_slab) {
+			run_free(state, ptr, DBLL_CLASS_SLAB);
+		}
+
+		return DBLL_NULL_ERR;
 	}
 
-	return DBLL_OK;
+	if(run_zero(state, ptr, slot_count) < 0) {
+		return DBLL_NULL_ERR;
+	}
+
+	return ptr;
 }
 
-int dbll_empty_slot_unload(dbll_empty_slot_t *slot) {
-	if(slot == NULL) {
+// puts a slot back at the start of its class's free list
+static int class_free(dbll_state_t *state, int class, dbll_ptr_t ptr) {
+	dbll_ptr_t head_ptr = DBLL_NULL;
+	dbll_index_t head_index = class_head_index(state, class);
+	dbll_index_t index = state_index(state, ptr);
+	if(
+		head_index < 0 ||
+		index < 0 ||
+		index_ptr_read(state, head_index, &head_ptr) < 0 ||
+		index_ptr_write(state, index, head_ptr) < 0 ||
+		index_ptr_write(state, head_index, ptr) < 0
+	) {
 		return DBLL_ERR;
 	}
 
-	slot->this_ptr = DBLL_NULL;
-	slot->prev_ptr = DBLL_NULL;
-	slot->next_ptr = DBLL_NULL;
 	return DBLL_OK;
 }
 
-int dbll_empty_slot_write(
-	dbll_empty_slot_t *slot, 
-	dbll_state_t *state
+// a chain of count blocks, size bytes of it are the list's data
+static int list_chain_alloc(
+	dbll_list_t *list,
+	dbll_state_t *state,
+	dbll_index_t count,
+	dbll_index_t size
 ) {
+	dbll_data_slot_t slot = { 0 };
+	dbll_ptr_t first_ptr = dbll_state_alloc(state);
+	dbll_ptr_t last_ptr = DBLL_NULL;
 	if(
-		!dbll_empty_slot_valid(slot) ||
-		!dbll_state_valid(state)
+		first_ptr == DBLL_NULL ||
+		data_slot_read(&slot, state, first_ptr) < 0 ||
+		data_slot_append(&slot, state, count - 1, &last_ptr) < 0
 	) {
 		return DBLL_ERR;
 	}
 
-	int index = dbll_ptr_to_index(state, slot->this_ptr);
-	int ptr_size = state->header.ptr_size;
-	if(
-		index == -1 ||
-		ptr_size <= 0 ||
-		dbll_ptr_index_copy(
-			state,
-			slot->this_ptr,
-			index
-		) < 0 ||
-
-		dbll_ptr_index_copy(
-			state,
-			slot->prev_ptr,
-			index + ptr_size
-		) < 0 ||
-
-		dbll_ptr_index_copy(
-			state,
-			slot->next_ptr,
-			index + (ptr_size * 2)
-		) < 0
-	) {
+	list->data_ptr = first_ptr;
+	list->data_size = list_data_stored(state, size);
+	list->data_kind = DBLL_DATA_CHAIN;
+	if(dbll_list_write(list, state) < 0) {
 		return DBLL_ERR;
 	}
 
+	list->data_tail_ptr = last_ptr;
+	list->data_generation = state->generation;
 	return DBLL_OK;
 }
 
-int dbll_empty_slot_clip(
-	dbll_empty_slot_t *slot,
-	dbll_state_t *state
+// a chain of blocks blocks, all of them data
+int dbll_list_data_alloc(
+	dbll_list_t *list,
+	dbll_state_t *state,
+	dbll_index_t blocks
 ) {
 	if(
-		!dbll_empty_slot_valid(slot) ||
-		!dbll_state_valid(state)
+		!dbll_list_valid(list) ||
+		!dbll_state_valid(state) ||
+		!state_writable(state) ||
+		list->data_ptr != DBLL_NULL ||
+		list->data_kind == DBLL_DATA_INLINE ||
+		blocks < 0 ||
+		list_data_stored(
+			state, 
+			blocks * state->header.data_slot_size
+		) > list_data_max(state)
 	) {
 		return DBLL_ERR;
 	}
 
 	if(
-		slot->prev_ptr == DBLL_NULL &&
-		slot->next_ptr == DBLL_NULL &&
-		state->last_empty.this_ptr == slot->this_ptr &&
-		dbll_empty_slot_unload(&state->last_empty) < 0
+		blocks > 0 &&
+		list_chain_alloc(
+			list, 
+			state, 
+			blocks, 
+			blocks * state->header.data_slot_size
+		) < 0
 	) {
 		return DBLL_ERR;
 	}
 
+	return DBLL_OK;
+}
+
+// size bytes go in the list itself if they fit, then the smallest size
+// class they fit in, or an extent if that's none of them. older files
+// don't have classes, there they go in a chain unless they're big
+// enough for an extent
+int dbll_list_data_alloc_bytes(
+	dbll_list_t *list,
+	dbll_state_t *state,
+	dbll_index_t size
+) {
 	if(
-		slot->prev_ptr != DBLL_NULL &&
-		slot->next_ptr == DBLL_NULL &&
-		state->last_empty.this_ptr == slot->this_ptr &&
-		dbll_empty_slot_load(
-			&state->last_empty,
-			state,
-			slot->prev_ptr
-		) < 0
+		!dbll_list_valid(list) ||
+		!dbll_state_valid(state) ||
+		!state_writable(state) ||
+		list->data_ptr != DBLL_NULL ||
+		list->data_kind == DBLL_DATA_INLINE ||
+		size < 0 ||
+		list_data_stored(state, size) > list_data_max(state)
 	) {
 		return DBLL_ERR;
 	}
 
-	if(slot->prev_ptr != DBLL_NULL) {
-		dbll_empty_slot_t prev_slot = { 0 };
-		if(
-			dbll_empty_slot_load(
-				&prev_slot, 
-				state,
-				slot->prev_ptr
-			) < 0
-		) {
+	if(size == 0) {
+		return DBLL_OK;
+	}
+
+	int version = state->header.version;
+	if(version >= 2 && size <= list_inline_max(state)) {
+		list->data_ptr = DBLL_NULL;
+		list->data_size = size;
+		list->data_kind = DBLL_DATA_INLINE;
+		memset(list->data_inline, 0, sizeof(list->data_inline));
+		if(dbll_list_write(list, state) < 0) {
 			return DBLL_ERR;
 		}
 
-		prev_slot.next_ptr = slot->next_ptr;
-		dbll_empty_slot_write(&prev_slot, state);
+		return DBLL_OK;
 	}
 
-	if(slot->next_ptr != DBLL_NULL) {
-		dbll_empty_slot_t next_slot = { 0 };
+	int class = list_data_class(state, size);
+	if(version < 2 || (version < 3 && class < DBLL_CLASS_COUNT)) {
 		if(
-			dbll_empty_slot_load(
-				&next_slot,
-				state,
-				slot->next_ptr
+			list_chain_alloc(
+				list, 
+				state, 
+				list_data_blocks(state, size), 
+				size
 			) < 0
 		) {
 			return DBLL_ERR;
 		}
 
-		next_slot.prev_ptr = slot->prev_ptr;
-		dbll_empty_slot_write(&next_slot, state);
-	}
-
-	if(dbll_empty_slot_unload(slot) < 0) {
-		return DBLL_ERR;
+		return DBLL_OK;
 	}
 
-	return DBLL_OK;
-}
-
-int dbll_data_slot_valid(dbll_data_slot_t *slot) {
-	return (
-		DBLL_VALID(slot != NULL) &&
-		DBLL_VALID(slot->data_index >= 0) &&
-		DBLL_VALID(slot->this_ptr != DBLL_NULL) && DBLL_VALID(
-			slot->next_ptr != slot->this_ptr || (
-				slot->next_ptr == DBLL_NULL &&
-				slot->this_ptr == DBLL_NULL
-			)
-		)
-	);
-}
+	if(class == DBLL_CLASS_COUNT) {
+		if(dbll_list_data_alloc_extent(list, state, size) < 0) {
+			return DBLL_ERR;
+		}
 
-int dbll_data_slot_load(
-	dbll_data_slot_t *slot, 
-	dbll_state_t *state, 
-	dbll_ptr_t ptr
-) {
-	if(!dbll_state_valid(state) || slot == NULL) {
-		return DBLL_ERR;
+		return DBLL_OK;
 	}
 
-	int index = dbll_ptr_to_index(state, ptr);
-	int ptr_size = state->header.ptr_size;
-	if(
-		index == -1 ||
-		ptr_size <= 0 ||
-		dbll_index_ptr_copy(
-			state, 
-			index, 
-			&slot->next_ptr
-		) < 0
-	) {
+	dbll_ptr_t ptr = class_alloc(state, class);
+	if(ptr == DBLL_NULL) {
 		return DBLL_ERR;
 	}
-	
-	slot->data_index = index + state->header.ptr_size;
-	slot->this_ptr = ptr;
-	return DBLL_OK;
-}
 
-int dbll_data_slot_unload(dbll_data_slot_t *slot) {
-	if(slot == NULL) {
+	list->data_ptr = ptr;
+	list->data_size = size;
+	list->data_kind = DBLL_DATA_CLASS;
+	list->data_tail_ptr = DBLL_NULL;
+	if(dbll_list_write(list, state) < 0) {
 		return DBLL_ERR;
 	}
 
-	slot->next_ptr = DBLL_NULL;
-	slot->data_index = 0;
-	slot->is_marked = 0;
-	slot->this_ptr = DBLL_NULL;
 	return DBLL_OK;
 }
 
-int dbll_data_slot_next(
-	dbll_data_slot_t *slot, 
-	dbll_state_t *state
+int dbll_list_data_resize(
+	dbll_list_t *list, 
+	dbll_state_t *state, 
+	dbll_index_t size
 ) {
 	if(
-		!dbll_data_slot_valid(slot) ||
+		!dbll_list_valid(list) ||
 		!dbll_state_valid(state) ||
-		slot->next_ptr == DBLL_NULL
+		!state_writable(state)
 	) {
 		return DBLL_ERR;
 	}
 
-	if(
-		dbll_data_slot_load(
-			slot,
-			state,
-			slot->next_ptr
-		) < 0
-	) {
-		return DBLL_ERR;
+	// an inline value has no blocks, taking any away drops it
+	if(list->data_kind == DBLL_DATA_INLINE) {
+		if(size > 0) {
+			return DBLL_ERR;
+		}
+
+		if(size < 0) {
+			list->data_size = 0;
+			list->data_kind = DBLL_DATA_CHAIN;
+			memset(list->data_inline, 0, sizeof(list->data_inline));
+			if(dbll_list_write(list, state) < 0) {
+				return DBLL_ERR;
+			}
+		}
+
+		return DBLL_OK;
 	}
 
-	return DBLL_OK;
-}
+	if(list->data_ptr == DBLL_NULL) {
+		if(
+			size < 0 ||
+			dbll_list_data_alloc(list, state, size) < 0
+		) {
+			return DBLL_ERR;
+		}
 
-int dbll_data_slot_free(
-	dbll_data_slot_t *slot,
-	dbll_state_t *state
-) {
-	if(
-		!dbll_data_slot_valid(slot) ||
-		!dbll_state_valid(state)
-	) {
-		return DBLL_ERR;
+		return DBLL_OK;
 	}
 
-	slot->is_marked = 1;
-		if(slot->next_ptr != DBLL_NULL && !slot->is_marked) {
-			dbll_data_slot_t next_slot = *slot;
-			if(dbll_data_slot_next(&next_slot, state) < 0) {
-				return DBLL_ERR;
-			}
-			
-			if(dbll_data_slot_free(&next_slot, state) < 0) {
-				return DBLL_ERR;
-			}
+	// a run can only give back blocks off its end, growing it
+	// would need the blocks after it
+	if(list->data_kind == DBLL_DATA_EXTENT) {
+		dbll_index_t count = list_run_blocks(state, list->data_size);
+		if(
+			size > 0 ||
+			count + size < 0 ||
+			list_run_index(list, state) < 0 ||
+			run_free(state, list->data_ptr + count + size, -size) < 0
+		) {
+			return DBLL_ERR;
 		}
 
-		if(slot->is_marked) {
-			return DBLL_OK;
+		dbll_index_t data_size = (count + size) * state->header.block_size;
+		if(list->data_size < data_size) {
+			data_size = list->data_size;
 		}
-	slot->is_marked = 0;
 
-	dbll_state_mark_free(state, slot->this_ptr);
-	dbll_data_slot_unload(slot);
-	return DBLL_OK;
-}
+		list->data_size = data_size;
+		if(data_size == 0) {
+			list->data_ptr = DBLL_NULL;
+			list->data_kind = DBLL_DATA_CHAIN;
+		}
 
-// doesn't prevent cyclic data slot access
-// in order to make circular memory possible
-int dbll_data_slot_page(
-	dbll_data_slot_t *slot,
-	dbll_state_t *state,
-	int user_index
-) {
-	if(
-		!dbll_data_slot_valid(slot) ||
-		!dbll_state_valid(state)
-	) {
-		return -1;
-	}
-	
-	int page_number = user_index / state->header.data_slot_size;
-	int page_offset = user_index % state->header.data_slot_size;
-	dbll_data_slot_t fetch_slot = *slot;
-	for(
-		int i = 0; 
-		i < page_number && 
-		fetch_slot.next_ptr != DBLL_NULL; 
-		i++
-	) {
-		if(dbll_data_slot_next(&fetch_slot, state) < 0) {
-
-			// dont unload it because we would leak
-			// memory in the database otherwise, 
-			// rather, get every element one by one
-			// and clean them up
-			dbll_data_slot_free(slot, state);
-			return -1;
+		if(dbll_list_write(list, state) < 0) {
+			return DBLL_ERR;
 		}
+
+		return DBLL_OK;
 	}
 
-	return fetch_slot.data_index + page_offset;
-}
+	// a class slot is all or nothing, taking away all of its
+	// blocks puts it back on its class's free list
+	if(list->data_kind == DBLL_DATA_CLASS) {
+		int class = list_data_class(state, list->data_size);
+		if(
+			size != -((dbll_index_t)(1) << class) ||
+			list_run_index(list, state) < 0 ||
+			class_free(state, class, list->data_ptr) < 0
+		) {
+			return DBLL_ERR;
+		}
 
-int dbll_data_slot_resize(
-	dbll_data_slot_t *slot,
-	dbll_state_t *state,
-	int size
-) {
+		list->data_ptr = DBLL_NULL;
+		list->data_size = 0;
+		list->data_kind = DBLL_DATA_CHAIN;
+		if(dbll_list_write(list, state) < 0) {
+			return DBLL_ERR;
+		}
+
+		return DBLL_OK;
+	}
+
+	// need first slot to feed in dbll_data_slot_last in order
+	// to get last slot
+	dbll_data_slot_t slot = { 0 };
+	dbll_index_t count = 0;
 	if(
-		!dbll_data_slot_valid(slot) ||
-		!dbll_state_valid(state)
+		data_slot_read(
+			&slot, 
+			state, 
+			list->data_ptr
+		) < 0 ||
+
+		chain_end(state, list->data_ptr, NULL, &count) < 0 ||
+		count + size < 0 ||
+		list_data_stored(
+			state, 
+			(count + size) * state->header.data_slot_size
+		) > list_data_max(state)
 	) {
 		return DBLL_ERR;
 	}
 
-	if(size == 0) {
-
-		// nothing to allocate but shouldn't error
-		return DBLL_OK;
-	}
+	// cutting all of it leaves the list without data
+	if(count + size == 0) {
+		if(dbll_data_slot_free(&slot, state) < 0) {
+			return DBLL_ERR;
+		}
 
-	if(size < 0) {
+		list->data_ptr = DBLL_NULL;
+		list->data_size = 0;
+	} else {
 		if(
-			dbll_data_slot_cut_end(
-				slot,
+			dbll_data_slot_resize(
+				&slot,
 				state,
-				-size
+				size
 			) < 0
 		) {
 			return DBLL_ERR;
 		}
 
-		return DBLL_OK;
-	}
-
-	dbll_ptr_t last_ptr = dbll_data_slot_last(
-		slot,
-		state,
-		NULL
-	);
-
-	if(last_ptr == DBLL_NULL) {
-		return DBLL_ERR;
-	}
+		// growing gives the list all of the new blocks, shrinking
+		// only takes away what was in the blocks that are gone
+		dbll_index_t data_size = (count + size) * state->header.data_slot_size;
+		if(size < 0 && list_data_used(list, state) < data_size) {
+			data_size = list_data_used(list, state);
+		}
 
-	dbll_data_slot_t last_slot = { 0 };
-	if(
-		dbll_data_slot_load(
-			&last_slot,
-			state,
-			last_ptr
-		) < 0
-	) {
-		return DBLL_ERR;
+		list->data_size = list_data_stored(state, data_size);
 	}
 
-	if(
-		dbll_data_slot_alloc(
-			&last_slot,
-			state,
-			size
-		) < 0
-	) {
+	list->data_tail_ptr = DBLL_NULL;
+	if(dbll_list_write(list, state) < 0) {
 		return DBLL_ERR;
 	}
 
-	return DBLL_ERR;
+	return DBLL_OK;
 }
 
-int dbll_data_slot_alloc(
-	dbll_data_slot_t *slot,
+// writes n bytes after the data the list already has. the last block is
+// kept in the list after the first time, so as long as the same list is
+// used and no chain changes in between, it doesn't walk the chain again
+int dbll_list_data_append(
+	dbll_list_t *list,
 	dbll_state_t *state,
-	int size
+	const uint8_t *mem,
+	dbll_index_t n
 ) {
 	if(
-		!dbll_data_slot_valid(slot) ||
+		!dbll_list_valid(list) ||
 		!dbll_state_valid(state) ||
-		size < 0
+		!state_writable(state) ||
+		list->this_ptr == DBLL_NULL ||
+		list->data_kind == DBLL_DATA_EXTENT ||
+		list->data_kind == DBLL_DATA_CLASS ||
+		mem == NULL ||
+		n < 0 ||
+		list_data_stored(
+			state, 
+			list_data_used(list, state) + n
+		) > list_data_max(state)
 	) {
 		return DBLL_ERR;
 	}
 
-	dbll_data_slot_t *prev_slot = NULL;
-	dbll_data_slot_t temp_slot = { 0 };
-	dbll_data_slot_t prev_temp_slot = { 0 };
-	for(int i = 0; i < size; i++) {
-		dbll_ptr_t new_slot_ptr = dbll_state_alloc(state);
-		if(new_slot_ptr == DBLL_NULL) {
-			return DBLL_ERR;
-		}
+	if(n == 0) {
+		return DBLL_OK;
+	}
+
+	// an inline value stays one until it doesn't fit in the
+	// list anymore, then what it had goes into a chain first
+	if(list->data_kind == DBLL_DATA_INLINE) {
+		dbll_index_t inline_size = list->data_size;
+		if(inline_size + n <= list_inline_max(state)) {
+			memcpy(list->data_inline + inline_size, mem, n);
+			list->data_size += n;
+			if(dbll_list_write(list, state) < 0) {
+				return DBLL_ERR;
+			}
 
-		dbll_data_slot_t *current_slot = i == 0
-			? slot
-			: &temp_slot;
+			return DBLL_OK;
+		}
 
+		uint8_t inline_mem[DBLL_INLINE_MAX] = { 0 };
+		memcpy(inline_mem, list->data_inline, inline_size);
+		memset(list->data_inline, 0, sizeof(list->data_inline));
+		list->data_size = 0;
+		list->data_kind = DBLL_DATA_CHAIN;
 		if(
-			dbll_data_slot_load(
-				current_slot, 
+			dbll_list_data_append(
+				list, 
 				state, 
-				new_slot_ptr
+				inline_mem, 
+				inline_size
 			) < 0
 		) {
 			return DBLL_ERR;
 		}
+	}
+
+	int page_size = state->header.data_slot_size;
+	dbll_index_t data_size = list_data_used(list, state);
+	dbll_index_t used_size = data_size;
+	dbll_data_slot_t tail_slot = { 0 };
+	if(list->data_ptr == DBLL_NULL) {
+		dbll_ptr_t first_ptr = dbll_state_alloc(state);
+		if(
+			first_ptr == DBLL_NULL ||
+			data_slot_read(&tail_slot, state, first_ptr) < 0
+		) {
+			return DBLL_ERR;
+		}
 
-		current_slot->next_ptr = DBLL_NULL;
-		if(prev_slot != NULL) {
-			prev_slot->next_ptr = current_slot->this_ptr;
+		list->data_ptr = first_ptr;
+		used_size = 0;
+	} else {
+		if(
+			list->data_tail_ptr == DBLL_NULL ||
+			list->data_generation != state->generation
+		) {
+			dbll_index_t count = 0;
 			if(
-				dbll_data_slot_write(
-					prev_slot,
-					state
+				chain_end(
+					state, 
+					list->data_ptr, 
+					&list->data_tail_ptr, 
+					&count
 				) < 0
 			) {
 				return DBLL_ERR;
 			}
 		}
 
-		if(i != 0) {
-			memcpy(
-				&prev_temp_slot,
-				current_slot,
-				sizeof(dbll_data_slot_t)
-			);
+		if(data_slot_read(&tail_slot, state, list->data_tail_ptr) < 0) {
+			return DBLL_ERR;
 		}
 
-		prev_slot = i == 0
-			? slot
-			: &prev_temp_slot;
+		// how much of the last block is taken, a full one is
+		// page_size and not 0
+		used_size -= (list_data_blocks(state, used_size) - 1) * page_size;
+		if(list->data_size == 0) {
+			used_size = 0;
+		}
 	}
-	
+
+	// fill up what's left of the last block, then the rest
+	// goes in new blocks after it
+	dbll_index_t fill_size = page_size - used_size;
+	if(fill_size > n) {
+		fill_size = n;
+	}
+
+	dbll_index_t new_count = list_data_blocks(state, n - fill_size);
+	dbll_ptr_t last_ptr = DBLL_NULL;
+	if(
+		state_write(
+			state, 
+			tail_slot.data_index + used_size, 
+			mem, 
+			fill_size
+		) < 0 ||
+
+		data_slot_append(&tail_slot, state, new_count, &last_ptr) < 0 ||
+		(
+			new_count > 0 &&
+			data_slot_write_read(
+				&tail_slot,
+				state,
+				page_size,
+				(uint8_t *)(mem + fill_size),
+				n - fill_size,
+				1
+			) < 0
+		)
+	) {
+		return DBLL_ERR;
+	}
+
+	// version 0 files only count blocks, so what gets appended next
+	// goes after the last block and not right after these bytes
+	list->data_size = list_data_stored(state, data_size + n);
+	if(dbll_list_write(list, state) < 0) {
+		return DBLL_ERR;
+	}
+
+	list->data_tail_ptr = last_ptr;
+	list->data_generation = state->generation;
 	return DBLL_OK;
 }
 
-int dbll_data_slot_write(
-	dbll_data_slot_t *slot,
-	dbll_state_t *state
+// gives the list size bytes of data in one run of blocks. there are
+// no pointers in the way, so the data can be read or written in one go
+int dbll_list_data_alloc_extent(
+	dbll_list_t *list,
+	dbll_state_t *state,
+	dbll_index_t size
 ) {
 	if(
-		!dbll_data_slot_valid(slot) ||
-		!dbll_state_valid(state)
+		!dbll_list_valid(list) ||
+		!dbll_state_valid(state) ||
+		!state_writable(state) ||
+		list->data_ptr != DBLL_NULL ||
+		list->data_kind == DBLL_DATA_INLINE ||
+		size < 0 ||
+		size > list_data_max(state) ||
+
+		// older files have nowhere to keep the kind
+		state->header.version < 2
 	) {
 		return DBLL_ERR;
 	}
 
-	int index = dbll_ptr_to_index(
-		state,
-		slot->this_ptr
+	if(size == 0) {
+		return DBLL_OK;
+	}
+
+	dbll_ptr_t first_ptr = dbll_state_alloc_run(
+		state, 
+		list_run_blocks(state, size)
 	);
 
-	if(index == -1) {
+	if(first_ptr == DBLL_NULL) {
 		return DBLL_ERR;
 	}
 
-	if(
-		dbll_ptr_index_copy(
-			state,
-			slot->next_ptr,
-			index
-		) < 0
-	) {
+	list->data_ptr = first_ptr;
+	list->data_size = size;
+	list->data_kind = DBLL_DATA_EXTENT;
+	list->data_tail_ptr = DBLL_NULL;
+	if(dbll_list_write(list, state) < 0) {
 		return DBLL_ERR;
 	}
 
 	return DBLL_OK;
 }
 
-// recurse in here to get size, that way when the
-// recursion is unwinded we can see when to cut
-// with the size pointer, but the user shouldn't
-// have to do that, so it's done in dbll_data_slot_cut_end
-// instead 
-static int data_slot_cut_end_inner(
-	dbll_data_slot_t *slot,
+// copies between mem and the list's data, whatever kind it is. it
+// can't go past the bytes the list has
+static int list_data_write_read(
+	dbll_list_t *list,
 	dbll_state_t *state,
-	int *size,
-	int cut_size
+	dbll_index_t offset,
+	uint8_t *mem,
+	dbll_index_t size,
+	int is_write
 ) {
 	if(
-		!dbll_data_slot_valid(slot) ||
-		!dbll_state_valid(state)
+		!dbll_list_valid(list) ||
+		!dbll_state_valid(state) ||
+		(is_write && !state_writable(state)) ||
+		offset < 0 ||
+		mem == NULL ||
+		size < 0 ||
+		offset + size > list_data_used(list, state)
 	) {
 		return DBLL_ERR;
 	}
 
-	dbll_data_slot_t current_slot = *slot;
-	int current_size = *size;
-	slot->is_marked = 1;
-		if(slot->next_ptr != DBLL_NULL && !slot->is_marked) {
-			dbll_data_slot_t next_slot = *slot;
-			if(dbll_data_slot_next(&next_slot, state) < 0) {
-				return DBLL_ERR;
-			}
+	if(size == 0) {
+		return DBLL_OK;
+	}
 
-			(*size)++;
-			if(
-				data_slot_cut_end_inner(
-					&next_slot, 
-					state, 
-					size, 
-					cut_size
-				) < 0
-			) {
-				return DBLL_ERR;
-			}
+	// reading an inline value doesn't touch the file at all
+	if(list->data_kind == DBLL_DATA_INLINE) {
+		if(!is_write) {
+			memcpy(mem, list->data_inline + offset, size);
+			return DBLL_OK;
 		}
 
-		if(slot->is_marked) {
-			return DBLL_OK;
+		memcpy(list->data_inline + offset, mem, size);
+		if(dbll_list_write(list, state) < 0) {
+			return DBLL_ERR;
 		}
-	slot->is_marked = 0;
 
-	// sets the next_ptr to null so that dbll_data_slot_free
-	// doesn't free the whole thing due to how dbll_data_slot_last works
-	if(current_size == *size) {
-		slot->next_ptr = DBLL_NULL;
+		return DBLL_OK;
+	}
+
+	if(list->data_kind == DBLL_DATA_CHAIN) {
+		dbll_data_slot_t slot = { 0 };
 		if(
-			dbll_data_slot_write(
-				slot,
-				state
+			data_slot_read(&slot, state, list->data_ptr) < 0 ||
+			data_slot_write_read(
+				&slot,
+				state,
+				offset,
+				mem,
+				size,
+				is_write
 			) < 0
 		) {
 			return DBLL_ERR;
@@ -1208,166 +4294,227 @@ static int data_slot_cut_end_inner(
 
 		return DBLL_OK;
 	}
-	
-	if(current_size == (*size) - cut_size) {
-		if(
-			dbll_data_slot_free(
-				&current_slot,
-				state
-			) < 0
-		) {
+
+	dbll_index_t index = list_run_index(list, state);
+	if(index < 0) {
+		return DBLL_ERR;
+	}
+
+	if(is_write) {
+		if(state_write(state, index + offset, mem, size) < 0) {
 			return DBLL_ERR;
 		}
+	} else if(dbll_file_read(&state->file, index + offset, mem, size) < 0) {
+		return DBLL_ERR;
 	}
 
 	return DBLL_OK;
 }
 
-int dbll_data_slot_cut_end(
-	dbll_data_slot_t *slot,
+int dbll_list_data_read(
+	dbll_list_t *list,
+	dbll_state_t *state,
+	dbll_index_t offset,
+	uint8_t *mem,
+	dbll_index_t size
+) {
+	if(list_data_write_read(list, state, offset, mem, size, 0) < 0) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_list_data_write(
+	dbll_list_t *list,
 	dbll_state_t *state,
-	int size
+	dbll_index_t offset,
+	const uint8_t *mem,
+	dbll_index_t size
 ) {
 	if(
-		!dbll_data_slot_valid(slot) ||
-		!dbll_state_valid(state) ||
-		size < 0
+		list_data_write_read(
+			list, 
+			state, 
+			offset, 
+			(uint8_t *)(mem), 
+			size, 
+			1
+		) < 0
 	) {
 		return DBLL_ERR;
 	}
 
-	if(size == 0) {
-		return DBLL_OK;
-	}
-	
-	int total_size = 0;
-	return data_slot_cut_end_inner(
-		slot,
-		state,
-		&total_size,
-		size
-	);
+	return DBLL_OK;
 }
 
-dbll_ptr_t dbll_data_slot_last(
-	dbll_data_slot_t *slot,
+// like dbll_data_slot_iov, an extent is always one span. so is an
+// inline value, it points into the list struct
+int dbll_list_data_iov(
+	dbll_list_t *list,
 	dbll_state_t *state,
-	int *size
+	dbll_index_t offset,
+	dbll_index_t size,
+	struct iovec *iovs,
+	int max
 ) {
 	if(
-		!dbll_data_slot_valid(slot) ||
-		!dbll_state_valid(state)
+		!dbll_list_valid(list) ||
+		!dbll_state_valid(state) ||
+		state->file.flags & DBLL_OPEN_POOL ||
+		offset < 0 ||
+		size < 0 ||
+		offset + size > list_data_used(list, state) ||
+		iovs == NULL ||
+		max < 0
 	) {
-		return DBLL_NULL_ERR;
+		return DBLL_ERR;
 	}
 
-	slot->is_marked = 1;
-		if(slot->next_ptr != DBLL_NULL && !slot->is_marked) {
-			dbll_data_slot_t next_slot = *slot;
-			if(dbll_data_slot_next(&next_slot, state) < 0) {
-				return DBLL_NULL_ERR;
-			}
+	if(size == 0 || max == 0) {
+		return 0;
+	}
 
-			if(size != NULL) {
-				(*size)++;
-			}
+	if(list->data_kind == DBLL_DATA_INLINE) {
+		iovs[0].iov_base = list->data_inline + offset;
+		iovs[0].iov_len = size;
+		return 1;
+	}
 
-			if(dbll_data_slot_last(&next_slot, state, size) == DBLL_NULL) {
-				return DBLL_NULL_ERR;
+	if(list->data_kind == DBLL_DATA_CHAIN) {
+		dbll_data_slot_t slot = { 0 };
+		if(data_slot_read(&slot, state, list->data_ptr) < 0) {
+			return DBLL_ERR;
+		}
+
+		return dbll_data_slot_iov(&slot, state, offset, size, iovs, max);
+	}
+
+	dbll_index_t index = list_run_index(list, state);
+	if(index < 0) {
+		return DBLL_ERR;
+	}
+
+	iovs[0].iov_base = state->file.mem + index + offset;
+	iovs[0].iov_len = size;
+	return 1;
+}
+
+// writes back only the dirty pages, neighbouring dirty pages are
+// written back together. async doesn't clear the dirty bits as
+// nothing has been waited on, so a later sync still covers them
+static int state_flush(dbll_state_t *state, int is_async) {
+
+	// the pool keeps track of its own dirty pages
+	if(state->file.flags & DBLL_OPEN_POOL) {
+		return dbll_file_sync(&state->file, is_async);
+	}
+
+	size_t page_count = state->dirty_size * 8;
+	size_t run_start = 0;
+	size_t run_size = 0;
+	for(size_t i = 0; i <= page_count; i++) {
+		if(
+			i < page_count &&
+			state->dirty[i / 8] & (1 << (i % 8))
+		) {
+			if(run_size == 0) {
+				run_start = i;
 			}
+
+			run_size++;
+			continue;
 		}
 
-		if(slot->is_marked) {
-			return DBLL_OK;
+		if(
+			run_size > 0 &&
+			file_sync_range(
+				&state->file,
+				run_start * page_size(),
+				run_size * page_size(),
+				is_async
+			) < 0
+		) {
+			return DBLL_ERR;
 		}
-	slot->is_marked = 0;
-	return slot->this_ptr;
+
+		run_size = 0;
+	}
+
+	if(!is_async && state->dirty != NULL) {
+		memset(state->dirty, 0, state->dirty_size);
+	}
+
+	return DBLL_OK;
 }
 
-static int data_slot_write_read(
-	dbll_data_slot_t *slot,
-	dbll_state_t *state,
-	int offset,
-	uint8_t *mem,
-	int mem_size,
-	int is_write
-) {
-	if(
-		!dbll_data_slot_valid(slot) ||
-		!dbll_state_valid(state) ||
-		offset < 0 ||
-		mem == NULL ||
-		mem_size < 0
-	) {
-		return DBLL_ERR;
+// physical size of the file if it only held the blocks in use
+static size_t state_logical_size(dbll_state_t *state) {
+	return (
+		state->header.header_size + 
+		state->header.block_count * state->header.block_size
+	);
+}
+
+// makes sure there is room for count more blocks past the logical end,
+// growing the file geometrically so appending blocks is amortized O(1)
+static int state_reserve(dbll_state_t *state, dbll_ptr_t count) {
+	dbll_ptr_t capacity = (
+		state->file.size -
+		state->header.header_size
+	) / state->header.block_size;
+
+	dbll_ptr_t needed = state->header.block_count + count;
+	if(needed <= capacity) {
+		return DBLL_OK;
 	}
 
-	int page_size = state->header.data_slot_size;
-	dbll_data_slot_t temp_slot = { 0 };
-	temp_slot = *slot;
-	while(offset > page_size) {
-		if(
-			dbll_data_slot_load(
-				&temp_slot,
-				state,
-				temp_slot.next_ptr
-			) < 0
-		) {
-			return DBLL_ERR;
-		}
+	dbll_ptr_t new_capacity = capacity * 2;
+	if(new_capacity < capacity + DBLL_GROW_MIN) {
+		new_capacity = capacity + DBLL_GROW_MIN;
+	}
 
-		offset -= page_size;
+	if(new_capacity < needed) {
+		new_capacity = needed;
 	}
 
-	int mem_index = 0;
-	int write_index = offset;
-	while(mem_size >= 0) {
-		if(write_index >= page_size) {
-			write_index = 0;
-			if(
-				dbll_data_slot_load(
-					&temp_slot,
-					state,
-					temp_slot.next_ptr
-				) < 0
-			) {
-				return DBLL_ERR;
-			}
-		}
+	size_t new_size = (
+		state->header.header_size +
+		new_capacity * state->header.block_size
+	);
 
-		if(is_write) {
-			state->file.mem[
-				write_index + temp_slot.data_index
-			] = mem[mem_index];
-		} else {
-			mem[mem_index] = state->file.mem[
-				write_index + temp_slot.data_index
-			];
-		}
+	if(
+		dbll_file_resize(
+			&state->file,
+			new_size - state->file.size
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
 
-		write_index++;
-		mem_index++;
-		mem_size--;
+	// growing happens less and less often, so it's
+	// used as the point to periodically write back
+	if(
+		state->sync == DBLL_SYNC_ASYNC &&
+		state_flush(state, 1) < 0
+	) {
+		return DBLL_ERR;
 	}
 
 	return DBLL_OK;
 }
 
-int dbll_data_slot_write_mem(
-	dbll_data_slot_t *slot,
-	dbll_state_t *state,
-	int offset,
-	uint8_t *mem,
-	int mem_size
-) {
+// cuts off spare capacity so the file ends where the blocks do
+static int state_fit(dbll_state_t *state) {
+	size_t logical_size = state_logical_size(state);
+	if(state->file.size <= logical_size) {
+		return DBLL_OK;
+	}
+
 	if(
-		data_slot_write_read(
-			slot,
-			state,
-			offset,
-			mem,
-			mem_size,
-			1
+		dbll_file_resize(
+			&state->file,
+			-(dbll_index_t)(state->file.size - logical_size)
 		) < 0
 	) {
 		return DBLL_ERR;
@@ -1376,24 +4523,38 @@ int dbll_data_slot_write_mem(
 	return DBLL_OK;
 }
 
-int dbll_data_slot_read_mem(
-	dbll_data_slot_t *slot,
-	dbll_state_t *state,
-	int offset,
-	uint8_t *mem,
-	int mem_size
-) {
+// the header in the file is written on sync and unload and when the
+// file is converted. in between the block count and the empty slot
+// list in it are only as new as the last of those
+static int state_header_write(dbll_state_t *state) {
+	state->header.empty_slot_ptr = state->last_empty.this_ptr;
+	return dbll_header_write(&state->header, state);
+}
+
+// picks the empty slot list back up from the header. if the header
+// is from before the last changes made it to the file, the slots it
+// points to might not be empty anymore, then the list is dropped,
+// which only loses the empty slots and not the blocks in use
+static int state_empty_load(dbll_state_t *state) {
+	dbll_header_t *header = &state->header;
+	dbll_empty_slot_t slot = { 0 };
 	if(
-		data_slot_write_read(
-			slot,
-			state,
-			offset,
-			mem,
-			mem_size,
-			0
-		) < 0
+		header->empty_slot_ptr == DBLL_NULL ||
+		!dbll_empty_slot_valid_ptr(state, header->empty_slot_ptr) ||
+		dbll_empty_slot_load(&slot, state, header->empty_slot_ptr) < 0 ||
+		slot.next_ptr != DBLL_NULL
 	) {
-		return DBLL_ERR;
+		header->empty_slot_ptr = DBLL_NULL;
+		header->first_empty_ptr = DBLL_NULL;
+		return DBLL_OK;
+	}
+
+	state->last_empty = slot;
+	if(
+		header->first_empty_ptr != DBLL_NULL &&
+		!dbll_empty_slot_valid_ptr(state, header->first_empty_ptr)
+	) {
+		header->first_empty_ptr = DBLL_NULL;
 	}
 
 	return DBLL_OK;
@@ -1413,16 +4574,26 @@ int dbll_state_valid(dbll_state_t *state) {
 }
 
 int dbll_state_load(dbll_state_t *state, const char *path) {
+	return dbll_state_load_flags(state, path, DBLL_OPEN_DEFAULT);
+}
+
+int dbll_state_load_flags(
+	dbll_state_t *state,
+	const char *path,
+	int flags
+) {
 	if(state == NULL || path == NULL) {
 		return DBLL_ERR;
 	}
 
 	state->last_empty = (dbll_empty_slot_t) { 0 };
 	state->root_list = (dbll_list_t) { 0 };
+	state->generation++;
 	if(
-		dbll_file_load(&state->file, path) < 0 ||
+		dbll_file_load_flags(&state->file, path, flags) < 0 ||
 		dbll_header_load(&state->header, &state->file) < 0 ||
-		dbll_list_load(&state->root_list, state, 1) < 0
+		dbll_list_load(&state->root_list, state, 1) < 0 ||
+		state_empty_load(state) < 0
 	) {
 		dbll_state_unload(state);
 		return DBLL_ERR;
@@ -1431,15 +4602,188 @@ int dbll_state_load(dbll_state_t *state, const char *path) {
 	return DBLL_OK;
 }
 
+int dbll_state_load_readonly(dbll_state_t *state, const char *path) {
+	return dbll_state_load_flags(state, path, DBLL_OPEN_READONLY);
+}
+
 int dbll_state_unload(dbll_state_t *state) {
 	if(state == NULL) {
 		return DBLL_ERR;
 	}
 
+	// version 0 headers don't store the block count, so spare
+	// capacity needs to go, otherwise it would be loaded back in
+	// as blocks. read only states can't have changed anything
+	if(dbll_state_valid(state) && state_writable(state)) {
+		if(state->header.version < 2) {
+			state_fit(state);
+		}
+
+		state_header_write(state);
+		if(state->sync == DBLL_SYNC_ASYNC) {
+			state_flush(state, 1);
+		} else if(state->sync != DBLL_SYNC_NONE) {
+			dbll_state_sync(state);
+		}
+	}
+
+	free(state->dirty);
+	state->dirty = NULL;
+	state->dirty_size = 0;
+
 	dbll_file_unload(&state->file);
 	dbll_header_unload(&state->header);
 	dbll_empty_slot_unload(&state->last_empty);
 	dbll_list_unload(&state->root_list);
+	state->sync = DBLL_SYNC_EXPLICIT;
+	return DBLL_OK;
+}
+
+int dbll_state_sync_policy(dbll_state_t *state, dbll_sync_e sync) {
+	if(
+		!dbll_state_valid(state) ||
+		sync < DBLL_SYNC_EXPLICIT ||
+		sync > DBLL_SYNC_COMMIT
+	) {
+		return DBLL_ERR;
+	}
+
+	state->sync = sync;
+	return DBLL_OK;
+}
+
+// always waits for everything to be written back,
+// no matter what the sync policy is
+int dbll_state_sync(dbll_state_t *state) {
+	if(!dbll_state_valid(state)) {
+		return DBLL_ERR;
+	}
+
+	if(
+		(
+			state_writable(state) &&
+			state_header_write(state) < 0
+		) ||
+
+		state_flush(state, 0) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_state_dirty(
+	dbll_state_t *state, 
+	dbll_index_t index, 
+	dbll_index_t size
+) {
+	if(
+		!dbll_state_valid(state) ||
+		!state_writable(state) ||
+		index < 0 ||
+		size < 0 ||
+		state_mark_dirty(state, index, size) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+int dbll_state_commit(dbll_state_t *state) {
+	if(!dbll_state_valid(state)) {
+		return DBLL_ERR;
+	}
+
+	switch(state->sync) {
+		case DBLL_SYNC_ASYNC: {
+			return state_flush(state, 1);
+		}
+
+		case DBLL_SYNC_COMMIT: {
+			return dbll_state_sync(state);
+		}
+
+		default: {
+			return DBLL_OK;
+		}
+	}
+}
+
+// gets a batch of blocks into memory at once, like a whole level of a
+// tree, before they're loaded one at a time
+int dbll_state_fetch(
+	dbll_state_t *state,
+	const dbll_ptr_t *ptrs,
+	dbll_index_t count
+) {
+	if(
+		!dbll_state_valid(state) ||
+		ptrs == NULL ||
+		count < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	if(count == 0) {
+		return DBLL_OK;
+	}
+
+	dbll_index_t *indexes = malloc(count * sizeof(dbll_index_t));
+	if(indexes == NULL) {
+		return DBLL_ERR;
+	}
+
+	for(dbll_index_t i = 0; i < count; i++) {
+		indexes[i] = state_index(state, ptrs[i]);
+		if(indexes[i] < 0) {
+			free(indexes);
+			return DBLL_ERR;
+		}
+	}
+
+	int result = dbll_file_fetch(
+		&state->file,
+		indexes,
+		count,
+		state->header.list_size
+	);
+
+	free(indexes);
+	return result;
+}
+
+// a null pointer advises the whole file, header and all
+int dbll_state_advise(
+	dbll_state_t *state,
+	dbll_ptr_t ptr,
+	dbll_ptr_t count,
+	dbll_advise_e advise
+) {
+	if(!dbll_state_valid(state)) {
+		return DBLL_ERR;
+	}
+
+	dbll_index_t index = 0;
+	dbll_index_t size = state->file.size;
+	if(ptr != DBLL_NULL) {
+		index = state_index(state, ptr);
+		size = count * state->header.block_size;
+	}
+
+	if(
+		index < 0 ||
+		file_advise_range(
+			&state->file,
+			index,
+			size,
+			advise
+		) < 0
+	) {
+		return DBLL_ERR;
+	}
+
 	return DBLL_OK;
 }
 
@@ -1481,6 +4825,7 @@ int dbll_state_make_replace(
 dbll_ptr_t dbll_state_empty_find(dbll_state_t *state) {
 	if(
 		!dbll_state_valid(state) ||
+		!state_writable(state) ||
 
 		// this is an error since last empty should
 		// always point to the last empty slot in the
@@ -1498,14 +4843,19 @@ dbll_ptr_t dbll_state_empty_find(dbll_state_t *state) {
 
 	dbll_ptr_t new_empty = state->last_empty.prev_ptr;
 	if(new_empty == DBLL_NULL) {
+		dbll_ptr_t current = state->last_empty.this_ptr;
 		dbll_empty_slot_unload(&state->last_empty);
-		return new_empty;
+		state->header.first_empty_ptr = DBLL_NULL;
+		return current;
 	}
 
+	// loaded into a copy first, the state has to stay valid
+	// while the slot is being loaded
 	dbll_ptr_t current = state->last_empty.this_ptr;
+	dbll_empty_slot_t new_slot = { 0 };
 	if(
-		dbll_empty_slot_load(
-			&state->last_empty,
+		empty_slot_read(
+			&new_slot,
 			state,
 			new_empty
 		) < 0
@@ -1513,6 +4863,7 @@ dbll_ptr_t dbll_state_empty_find(dbll_state_t *state) {
 		return DBLL_NULL_ERR;
 	}
 
+	state->last_empty = new_slot;
 	state->last_empty.next_ptr = DBLL_NULL;
 	if(
 		dbll_empty_slot_write(
@@ -1527,49 +4878,198 @@ dbll_ptr_t dbll_state_empty_find(dbll_state_t *state) {
 }
 
 dbll_ptr_t dbll_state_alloc(dbll_state_t *state) {
-	if(!dbll_state_valid(state)) {
+	if(
+		!dbll_state_valid(state) ||
+		!state_writable(state)
+	) {
 		return DBLL_NULL_ERR;
 	}
 
+	// empty slots still have their pointers in them,
+	// new blocks come out of the file zeroed so these should too
 	dbll_ptr_t empty_slot = dbll_state_empty_find(state);
 	if(empty_slot != DBLL_NULL) {
+		uint8_t zero[DBLL_PTR_MAX * 3 + DBLL_SIZE_MAX] = { 0 };
+		if(
+			state_write(
+				state,
+				state_index(state, empty_slot),
+				zero,
+				state->header.list_size
+			) < 0
+		) {
+			return DBLL_NULL_ERR;
+		}
+
 		return empty_slot;
 	}
 
+	if(state_reserve(state, 1) < 0) {
+		return DBLL_NULL_ERR;
+	}
+
+	// blocks are one-based, so the new count is also
+	// the pointer to the new block
+	state->header.block_count++;
+	return state->header.block_count;
+}
+
+dbll_ptr_t dbll_state_alloc_run(dbll_state_t *state, dbll_ptr_t count) {
 	if(
-		dbll_file_resize(
-			&state->file, 
-			state->header.list_size
-		) < 0
+		!dbll_state_valid(state) ||
+		!state_writable(state) ||
+		count == 0
 	) {
 		return DBLL_NULL_ERR;
 	}
 
-	int total_size = 0;
-	if(
-		dbll_state_total_size(
-			state,
-			&total_size
-		) < 0
+	// empty blocks at the end of the file come off the empty slot
+	// list the same way dbll_state_trim takes them, and become the
+	// start of the run. they're only counted until the file has
+	// grown for the rest, so a grow that fails doesn't lose them
+	dbll_ptr_t first_ptr = state->header.block_count + 1;
+	dbll_ptr_t reused_count = 0;
+	while(
+		reused_count < count &&
+		first_ptr - 1 != DBLL_NULL &&
+		dbll_empty_slot_valid_ptr(state, first_ptr - 1)
 	) {
+		first_ptr--;
+		reused_count++;
+	}
+
+	if(state_reserve(state, count - reused_count) < 0) {
 		return DBLL_NULL_ERR;
 	}
 
-	return (dbll_ptr_t)(total_size);
+	for(dbll_ptr_t i = 0; i < reused_count; i++) {
+		dbll_empty_slot_t slot = { 0 };
+		if(
+			empty_slot_read(&slot, state, first_ptr + i) < 0 ||
+			dbll_empty_slot_clip(&slot, state) < 0
+		) {
+			return DBLL_NULL_ERR;
+		}
+	}
+
+	// those still have their pointers in them, new blocks
+	// come out of the file zeroed so these should too
+	if(run_zero(state, first_ptr, reused_count) < 0) {
+		return DBLL_NULL_ERR;
+	}
+
+	state->header.block_count += count - reused_count;
+	return first_ptr;
+}
+
+int dbll_state_alloc_n(
+	dbll_state_t *state,
+	dbll_ptr_t n,
+	dbll_ptr_t *out,
+	int flags
+) {
+	if(
+		!dbll_state_valid(state) ||
+		!state_writable(state) ||
+		out == NULL ||
+		flags & ~DBLL_ALLOC_CONTIGUOUS
+	) {
+		return DBLL_ERR;
+	}
+
+	if(n == 0) {
+		return DBLL_OK;
+	}
+
+	if(flags & DBLL_ALLOC_CONTIGUOUS) {
+		dbll_ptr_t first_ptr = dbll_state_alloc_run(state, n);
+		if(first_ptr == DBLL_NULL) {
+			return DBLL_ERR;
+		}
+
+		for(dbll_ptr_t i = 0; i < n; i++) {
+			out[i] = first_ptr + i;
+		}
+
+		return DBLL_OK;
+	}
+
+	// empty slots are taken from the last one back, like
+	// dbll_state_empty_find does, but only the one left at the
+	// end gets written. that waits until the file has grown for
+	// the rest, so a grow that fails doesn't lose the slots
+	dbll_ptr_t taken_count = 0;
+	dbll_empty_slot_t slot = state->last_empty;
+	while(taken_count < n && slot.this_ptr != DBLL_NULL) {
+		dbll_ptr_t prev_ptr = slot.prev_ptr;
+		out[taken_count] = slot.this_ptr;
+		taken_count++;
+		dbll_empty_slot_unload(&slot);
+		if(
+			prev_ptr != DBLL_NULL &&
+			empty_slot_read(&slot, state, prev_ptr) < 0
+		) {
+			return DBLL_ERR;
+		}
+	}
+
+	dbll_ptr_t new_count = n - taken_count;
+	if(state_reserve(state, new_count) < 0) {
+		return DBLL_ERR;
+	}
+
+	if(taken_count > 0) {
+		slot.next_ptr = DBLL_NULL;
+		state->last_empty = slot;
+		if(slot.this_ptr == DBLL_NULL) {
+			state->header.first_empty_ptr = DBLL_NULL;
+		} else if(dbll_empty_slot_write(&state->last_empty, state) < 0) {
+			return DBLL_ERR;
+		}
+	}
+
+	// zeroed like dbll_state_alloc does
+	uint8_t zero[DBLL_PTR_MAX * 3 + DBLL_SIZE_MAX] = { 0 };
+	for(dbll_ptr_t i = 0; i < taken_count; i++) {
+		if(
+			state_write(
+				state,
+				state_index(state, out[i]),
+				zero,
+				state->header.list_size
+			) < 0
+		) {
+			return DBLL_ERR;
+		}
+	}
+
+	for(dbll_ptr_t i = 0; i < new_count; i++) {
+		out[taken_count + i] = state->header.block_count + 1 + i;
+	}
+
+	state->header.block_count += new_count;
+	return DBLL_OK;
 }
 
 int dbll_state_mark_free(dbll_state_t *state, dbll_ptr_t ptr) {
-	if(!dbll_state_valid(state)) {
+	if(
+		!dbll_state_valid(state) ||
+		!state_writable(state)
+	) {
 		return DBLL_ERR;
 	}
 
+	// a chain going through the block doesn't anymore
+	state->generation++;
 	dbll_empty_slot_t slot = { 0 };
-	if(dbll_empty_slot_load(&slot, state, ptr) < 0) {
+	if(empty_slot_read(&slot, state, ptr) < 0) {
 		return DBLL_ERR;
 	}
 	
 	slot.prev_ptr = DBLL_NULL;
-	if(state->last_empty.this_ptr != DBLL_NULL) {
+	if(state->last_empty.this_ptr == DBLL_NULL) {
+		state->header.first_empty_ptr = ptr;
+	} else {
 		dbll_empty_slot_t *prev_slot = &state->last_empty;
 		slot.prev_ptr = prev_slot->this_ptr;
 		prev_slot->next_ptr = ptr;
@@ -1585,22 +5085,12 @@ int dbll_state_mark_free(dbll_state_t *state, dbll_ptr_t ptr) {
 	}
 
 	state->last_empty = slot;
-	state->header.empty_slot_ptr = ptr;
-	if(
-		dbll_header_write(
-			&state->header,
-			state
-		) < 0
-	) {
-		return DBLL_ERR;
-	}
-
 	return DBLL_OK;
 }
 
 int dbll_state_total_size(
 	dbll_state_t *state,
-	int *size
+	dbll_ptr_t *size
 ) {
 	if(
 		!dbll_state_valid(state) ||
@@ -1609,20 +5099,19 @@ int dbll_state_total_size(
 		return DBLL_ERR;
 	}
 
-	*size = (
-		state->file.size -
-		state->header.header_size
-	) / state->header.list_size;
-
+	*size = state->header.block_count;
 	return DBLL_OK;
 }
 
 int dbll_state_trim(dbll_state_t *state) {
-	if(!dbll_state_valid(state)) {
+	if(
+		!dbll_state_valid(state) ||
+		!state_writable(state)
+	) {
 		return DBLL_ERR;
 	}
 
-	int current_ptr = 0;
+	dbll_ptr_t current_ptr = 0;
 	if(
 		dbll_state_total_size(
 			state,
@@ -1632,22 +5121,20 @@ int dbll_state_trim(dbll_state_t *state) {
 		return DBLL_ERR;
 	}
 
-	int trim_size = 0;
+	dbll_ptr_t trim_size = 0;
 	dbll_empty_slot_t slot = { 0 };
 
-	// total pointer/block size of file is computed in one-based indices as all
-	// sizes are, but not zero, this operation converts it to
-	// a zero-based index
-	current_ptr--;
+	// total block size is the same as the pointer to the last
+	// block, since pointers are one-based
 	while(
-		current_ptr >= 0 &&
+		current_ptr != DBLL_NULL &&
 		dbll_empty_slot_valid_ptr(
 			state,
 			current_ptr
 		)
 	) {
 		if(
-			dbll_empty_slot_load(
+			empty_slot_read(
 				&slot,
 				state,
 				current_ptr
@@ -1665,28 +5152,86 @@ int dbll_state_trim(dbll_state_t *state) {
 		current_ptr--;
 	}
 
-	if(trim_size > 0) {
+	state->header.block_count -= trim_size;
+	if(state_fit(state) < 0) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+// returns if the block was already marked, and marks it
+static int block_mark(uint8_t *marks, dbll_ptr_t ptr) {
+	int is_marked = marks[ptr / 8] & (1 << (ptr % 8));
+	marks[ptr / 8] |= 1 << (ptr % 8);
+	return is_marked;
+}
+
+// goes through the tree until it finds a list with an extent or a
+// class slot, returns 1 if there is one or any size class was used
+static int state_has_runs(dbll_state_t *state) {
+	if(state->header.class_ptr != DBLL_NULL) {
+		return 1;
+	}
+
+	uint8_t *marks = calloc(state->header.block_count / 8 + 1, 1);
+	dbll_ptr_t *lists = NULL;
+	dbll_index_t list_count = 0;
+	dbll_index_t list_capacity = 0;
+	if(
+		marks == NULL ||
+		ptr_push(&lists, &list_count, &list_capacity, 1) < 0
+	) {
+		free(marks);
+		return DBLL_ERR;
+	}
+
+	int result = 0;
+	while(list_count > 0 && result == 0) {
+		list_count--;
+		dbll_ptr_t ptr = lists[list_count];
+		if(ptr == DBLL_NULL || block_mark(marks, ptr)) {
+			continue;
+		}
+
+		dbll_list_t list = { 0 };
 		if(
-			dbll_file_resize(
-				&state->file,
-				-(trim_size * state->header.list_size)
-			) < 0
+			list_read(&list, state, ptr) < 0 ||
+			ptr_push(&lists, &list_count, &list_capacity, list.head_ptr) < 0 ||
+			ptr_push(&lists, &list_count, &list_capacity, list.tail_ptr) < 0
 		) {
-			return DBLL_ERR;
+			result = DBLL_ERR;
+		} else if(
+			list.data_kind == DBLL_DATA_EXTENT ||
+			list.data_kind == DBLL_DATA_CLASS
+		) {
+			result = 1;
 		}
-
-		return DBLL_OK;
 	}
 
-	return DBLL_OK;
+	free(lists);
+	free(marks);
+	return result;
 }
 
 int dbll_state_compact(dbll_state_t *state) {
-	if(!dbll_state_valid(state)) {
+	if(
+		!dbll_state_valid(state) ||
+		!state_writable(state)
+	) {
+		return DBLL_ERR;
+	}
+
+	// blocks move down without the pointers to them changing, so
+	// runs, class slabs and the class table wouldn't be where their
+	// pointers say anymore. files with any of them are left alone
+	if(state_has_runs(state) != 0) {
 		return DBLL_ERR;
 	}
 
-	int total_size = 0;
+	// blocks move, so every page table is out of date
+	state->generation++;
+	dbll_ptr_t total_size = 0;
 	if(
 		dbll_state_total_size(
 			state,
@@ -1696,7 +5241,7 @@ int dbll_state_compact(dbll_state_t *state) {
 		return DBLL_ERR;
 	}
 
-	int decrease_size = 0;
+	dbll_ptr_t decrease_size = 0;
 	dbll_ptr_t current_empty_ptr = state->last_empty.this_ptr;
 	while(
 		current_empty_ptr != DBLL_NULL &&
@@ -1707,7 +5252,7 @@ int dbll_state_compact(dbll_state_t *state) {
 	) {
 		dbll_empty_slot_t slot = { 0 };
 		if(
-			dbll_empty_slot_load(
+			empty_slot_read(
 				&slot,
 				state,
 				current_empty_ptr
@@ -1717,12 +5262,12 @@ int dbll_state_compact(dbll_state_t *state) {
 		}
 
 		for(
-			int i = current_empty_ptr + 1;
-			i < total_size;
+			dbll_ptr_t i = current_empty_ptr + 1;
+			i <= total_size;
 			i++
 		) {
-			int past_index = dbll_ptr_to_index(state, i - 1);
-			int current_index = dbll_ptr_to_index(state, i);
+			dbll_index_t past_index = state_index(state, i - 1);
+			dbll_index_t current_index = state_index(state, i);
 			if(
 				past_index == -1 ||
 				current_index == -1
@@ -1730,11 +5275,26 @@ int dbll_state_compact(dbll_state_t *state) {
 				return DBLL_ERR;
 			}
 
-			memcpy(
-				&state->file.mem[past_index],
-				&state->file.mem[current_index],
-				state->header.list_size
-			);
+			// all of the block, aligned blocks have padding after
+			// the list and runs use every byte of theirs
+			uint8_t block[DBLL_CACHE_LINE] = { 0 };
+			if(
+				dbll_file_read(
+					&state->file,
+					current_index,
+					block,
+					state->header.block_size
+				) < 0 ||
+
+				state_write(
+					state,
+					past_index,
+					block,
+					state->header.block_size
+				) < 0
+			) {
+				return DBLL_ERR;
+			}
 		}
 
 		total_size--;
@@ -1742,13 +5302,206 @@ int dbll_state_compact(dbll_state_t *state) {
 		current_empty_ptr = slot.next_ptr;
 	}
 
+	state->header.block_count -= decrease_size;
+	if(state_fit(state) < 0) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
+// flips the byte order of a field, which is the same going
+// to little endian as it is going back
+static int field_swap(dbll_state_t *state, dbll_index_t index, int size) {
+	uint8_t mem[DBLL_PTR_MAX] = { 0 };
+	uint8_t swapped[DBLL_PTR_MAX] = { 0 };
+	if(dbll_file_read(&state->file, index, mem, size) < 0) {
+		return DBLL_ERR;
+	}
+
+	for(int i = 0; i < size; i++) {
+		swapped[i] = mem[size - 1 - i];
+	}
+
+	return state_write(state, index, swapped, size);
+}
+
+// every field is read the old way before it gets swapped, so the
+// tree, data slots and empty slots are gone through as they're swapped.
+// blocks are marked so none of them are swapped twice
+static int state_swap(dbll_state_t *state, uint8_t *marks) {
+	int ptr_size = state->header.ptr_size;
+	dbll_ptr_t *lists = NULL;
+	dbll_index_t list_count = 0;
+	dbll_index_t list_capacity = 0;
+	if(ptr_push(&lists, &list_count, &list_capacity, 1) < 0) {
+		return DBLL_ERR;
+	}
+
+	while(list_count > 0) {
+		list_count--;
+		dbll_ptr_t ptr = lists[list_count];
+		if(ptr == DBLL_NULL || block_mark(marks, ptr)) {
+			continue;
+		}
+
+		dbll_list_t list = { 0 };
+		dbll_index_t index = state_index(state, ptr);
+		if(
+			index < 0 ||
+			list_read(&list, state, ptr) < 0 ||
+			ptr_push(&lists, &list_count, &list_capacity, list.head_ptr) < 0 ||
+			ptr_push(&lists, &list_count, &list_capacity, list.tail_ptr) < 0
+		) {
+			free(lists);
+			return DBLL_ERR;
+		}
+
+		// only the pointer in data slots is a field, the data is left
+		// alone. extents and class slots are all data
+		dbll_ptr_t data_ptr = list.data_kind == DBLL_DATA_CHAIN
+			? list.data_ptr
+			: DBLL_NULL;
+
+		while(data_ptr != DBLL_NULL && !block_mark(marks, data_ptr)) {
+			dbll_data_slot_t slot = { 0 };
+			if(
+				data_slot_read(&slot, state, data_ptr) < 0 ||
+				field_swap(
+					state, 
+					state_index(state, data_ptr), 
+					ptr_size
+				) < 0
+			) {
+				free(lists);
+				return DBLL_ERR;
+			}
+
+			data_ptr = slot.next_ptr;
+		}
+
+		if(
+			field_swap(state, index, ptr_size) < 0 ||
+			field_swap(state, index + ptr_size, ptr_size) < 0 ||
+			field_swap(state, index + (ptr_size * 2), ptr_size) < 0 ||
+			field_swap(
+				state, 
+				index + (ptr_size * 3), 
+				state->header.data_size
+			) < 0
+		) {
+			free(lists);
+			return DBLL_ERR;
+		}
+	}
+
+	free(lists);
+	dbll_ptr_t empty_ptr = state->last_empty.this_ptr;
+	while(empty_ptr != DBLL_NULL && !block_mark(marks, empty_ptr)) {
+		dbll_empty_slot_t slot = { 0 };
+		dbll_index_t index = state_index(state, empty_ptr);
+		if(
+			index < 0 ||
+			empty_slot_read(&slot, state, empty_ptr) < 0 ||
+			field_swap(state, index, ptr_size) < 0 ||
+			field_swap(state, index + ptr_size, ptr_size) < 0 ||
+			field_swap(state, index + (ptr_size * 2), ptr_size) < 0
+		) {
+			return DBLL_ERR;
+		}
+
+		empty_ptr = slot.prev_ptr;
+	}
+
+	// the class table is a head for every class's free list, and every
+	// free slot starts with a pointer to the next one
+	dbll_index_t table_index = state_index(state, state->header.class_ptr);
+	for(int i = 0; table_index >= 0 && i < DBLL_CLASS_COUNT; i++) {
+		dbll_index_t index = table_index + (i * ptr_size);
+		while(1) {
+			dbll_ptr_t slot_ptr = DBLL_NULL;
+			if(
+				index_ptr_read(state, index, &slot_ptr) < 0 ||
+				field_swap(state, index, ptr_size) < 0
+			) {
+				return DBLL_ERR;
+			}
+
+			if(slot_ptr == DBLL_NULL || block_mark(marks, slot_ptr)) {
+				break;
+			}
+
+			index = state_index(state, slot_ptr);
+			if(index < 0) {
+				return DBLL_ERR;
+			}
+		}
+	}
+
+	return DBLL_OK;
+}
+
+// moves every block to where it goes with the sizes in new_header.
+// blocks keep their pointers, so nothing in them changes. going to
+// bigger sizes every block moves up, so it starts from the last one
+// and never writes over a block that hasn't moved yet, going to
+// smaller ones it's the other way around. as much of a block is kept
+// as fits, which is all of it unless the padding goes away
+static int state_move(dbll_state_t *state, dbll_header_t *new_header) {
+	dbll_header_t *header = &state->header;
+	dbll_index_t new_size = (
+		new_header->header_size + 
+		header->block_count * new_header->block_size
+	);
+
 	if(
-		dbll_file_resize(
-			&state->file,
-			-(
-				decrease_size *
-				state->header.list_size
-			)
+		new_size > state->file.size &&
+		dbll_file_resize(&state->file, new_size - state->file.size) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	// header and block sizes always grow or shrink together
+	int is_up = new_header->header_size >= header->header_size;
+	int copy_size = header->block_size < new_header->block_size
+		? header->block_size
+		: new_header->block_size;
+
+	for(dbll_ptr_t i = 0; i < header->block_count; i++) {
+		dbll_ptr_t block = is_up
+			? header->block_count - 1 - i
+			: i;
+
+		uint8_t mem[DBLL_CACHE_LINE] = { 0 };
+		if(
+			dbll_file_read(
+				&state->file,
+				header->header_size + block * header->block_size,
+				mem,
+				copy_size
+			) < 0 ||
+
+			state_write(
+				state,
+				new_header->header_size + block * new_header->block_size,
+				mem,
+				new_header->block_size
+			) < 0
+		) {
+			return DBLL_ERR;
+		}
+	}
+
+	// the header padding has to be zero, it's where blocks used to be
+	uint8_t zero[DBLL_CACHE_LINE] = { 0 };
+	int encode_size = header_encode_size(new_header);
+	if(
+		new_header->header_size > encode_size &&
+		state_write(
+			state,
+			encode_size,
+			zero,
+			new_header->header_size - encode_size
 		) < 0
 	) {
 		return DBLL_ERR;
@@ -1757,9 +5510,147 @@ int dbll_state_compact(dbll_state_t *state) {
 	return DBLL_OK;
 }
 
+// version 0 files keep how many blocks a list's data is in, newer ones
+// how many bytes. every list in the tree has its size changed over, but
+// only once all of them are known to fit under the data kind, so a file
+// that can't be upgraded is left the way it was
+static int state_sizes_upgrade(
+	dbll_state_t *state,
+	dbll_header_t *new_header
+) {
+	uint8_t *marks = calloc(state->header.block_count / 8 + 1, 1);
+	dbll_ptr_t *lists = NULL;
+	dbll_index_t list_count = 0;
+	dbll_index_t list_capacity = 0;
+	dbll_ptr_t *sized = NULL;
+	dbll_index_t sized_count = 0;
+	dbll_index_t sized_capacity = 0;
+	if(
+		marks == NULL ||
+		ptr_push(&lists, &list_count, &list_capacity, 1) < 0
+	) {
+		free(marks);
+		return DBLL_ERR;
+	}
+
+	int page_size = state->header.data_slot_size;
+	dbll_index_t size_max = ((dbll_index_t)(1) << new_header->kind_shift) - 1;
+	int result = DBLL_OK;
+	while(list_count > 0 && result == DBLL_OK) {
+		list_count--;
+		dbll_ptr_t ptr = lists[list_count];
+		if(ptr == DBLL_NULL || block_mark(marks, ptr)) {
+			continue;
+		}
+
+		dbll_list_t list = { 0 };
+		if(
+			list_read(&list, state, ptr) < 0 ||
+			ptr_push(&lists, &list_count, &list_capacity, list.head_ptr) < 0 ||
+			ptr_push(&lists, &list_count, &list_capacity, list.tail_ptr) < 0 ||
+			(
+				list.data_size > 0 && (
+					list.data_size * page_size > size_max ||
+					ptr_push(&sized, &sized_count, &sized_capacity, ptr) < 0
+				)
+			)
+		) {
+			result = DBLL_ERR;
+		}
+	}
+
+	for(dbll_index_t i = 0; i < sized_count && result == DBLL_OK; i++) {
+		dbll_list_t list = { 0 };
+		if(list_read(&list, state, sized[i]) < 0) {
+			result = DBLL_ERR;
+			break;
+		}
+
+		list.data_size *= page_size;
+		if(dbll_list_write(&list, state) < 0) {
+			result = DBLL_ERR;
+		}
+	}
+
+	free(sized);
+	free(lists);
+	free(marks);
+	return result;
+}
+
+// rewrites every block that can be reached in the format flags ask for,
+// and brings the header up to DBLL_HEADER_VERSION. the newer header is
+// bigger, so upgrading moves every block like aligning does. it isn't
+// crash safe, so sync before and after
+int dbll_state_convert(dbll_state_t *state, int flags) {
+	if(
+		!dbll_state_valid(state) ||
+		!state_writable(state) ||
+		flags & ~format_flags
+	) {
+		return DBLL_ERR;
+	}
+
+	dbll_header_t new_header = state->header;
+	new_header.version = DBLL_HEADER_VERSION;
+	new_header.flags = flags;
+	header_sizes(&new_header);
+	header_codec(&new_header);
+
+	// a run's data goes through the padding too, it would take a
+	// different number of blocks once they're a different size
+	int changed_flags = flags ^ state->header.flags;
+	if(
+		(
+			changed_flags & DBLL_FORMAT_ALIGNED &&
+			state_has_runs(state) != 0
+		) || (
+			state->header.version < 2 &&
+			state_sizes_upgrade(state, &new_header) < 0
+		)
+	) {
+		return DBLL_ERR;
+	}
+
+	if(changed_flags & DBLL_FORMAT_NATIVE) {
+		uint8_t *marks = calloc(state->header.block_count / 8 + 1, 1);
+		if(marks == NULL) {
+			return DBLL_ERR;
+		}
+
+		int result = state_swap(state, marks);
+		free(marks);
+		if(result < 0) {
+			return DBLL_ERR;
+		}
+	}
+
+	if(
+		(
+			new_header.header_size != state->header.header_size ||
+			new_header.block_size != state->header.block_size
+		) &&
+		state_move(state, &new_header) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	// the root list's size means something else after upgrading
+	state->header = new_header;
+	if(
+		list_read(&state->root_list, state, 1) < 0 ||
+		state_fit(state) < 0 ||
+		state_header_write(state) < 0
+	) {
+		return DBLL_ERR;
+	}
+
+	return DBLL_OK;
+}
+
 int dbll_index_ptr_copy(
 	dbll_state_t *state, 
-	int index,
+	dbll_index_t index,
 	dbll_ptr_t *ptr
 ) {
 	if(
@@ -1771,18 +5662,8 @@ int dbll_index_ptr_copy(
 		return DBLL_ERR;
 	}
 
-	int ptr_size = state->header.ptr_size;
-	*ptr = 0;
-	index += ptr_size - 1;
-
-	// done manually and not with memcpy in order to enforce endianness
-	for(int i = 0; i < ptr_size && index >= 0; i++) {
-		*ptr |= (
-			(state->file.mem[index] << (i * 8)) &
-			(0xff << (i * 8))
-		);
-
-		index--;
+	if(index_ptr_read(state, index, ptr) < 0) {
+		return DBLL_ERR;
 	}
 
 	return DBLL_OK;
@@ -1790,7 +5671,7 @@ int dbll_index_ptr_copy(
 
 int dbll_index_size_copy(
 	dbll_state_t *state,
-	int index,
+	dbll_index_t index,
 	dbll_size_t *size
 ) {
 	if(
@@ -1803,29 +5684,31 @@ int dbll_index_size_copy(
 	}
 
 	int data_size = state->header.data_size;
-	*size = 0;
-	index += data_size - 1;
-
-	// done manually and not with memcpy in order to enforce endianness
-	for(int i = 0; i < data_size && index >= 0; i++) {
-		*size |= (
-			(state->file.mem[index] << (i * 8)) &
-			(0xff << (i * 8))
-		);
+	uint8_t buffer[DBLL_SIZE_MAX] = { 0 };
+	const uint8_t *mem = file_view(
+		&state->file, 
+		index, 
+		data_size, 
+		buffer
+	);
 
-		index--;
+	if(mem == NULL) {
+		return DBLL_ERR;
 	}
 
+	*size = state->header.codec->size_get(mem);
+
 	return DBLL_OK;
 }
 
 int dbll_ptr_index_copy(
 	dbll_state_t *state,
 	dbll_ptr_t ptr,
-	int index
+	dbll_index_t index
 ) {
 	if(
 		!dbll_state_valid(state) ||
+		!state_writable(state) ||
 		index < 0 ||
 		index >= state->file.size
 	) {
@@ -1833,24 +5716,20 @@ int dbll_ptr_index_copy(
 	}
 
 	int ptr_size = state->header.ptr_size;
-	index += ptr_size - 1;
+	uint8_t mem[DBLL_PTR_MAX] = { 0 };
+	state->header.codec->ptr_put(mem, ptr);
 
-	// done manually and not with memcpy in order to enforce endianness
-	for(int i = 0; i < ptr_size && index >= 0; i++) {
-		state->file.mem[index] = (ptr >> (i * 8)) & 0xff;
-		index--;
-	}
-	
-	return DBLL_OK;
+	return state_write(state, index, mem, ptr_size);
 }
 
 int dbll_size_index_copy(
 	dbll_state_t *state,
 	dbll_size_t size,
-	int index
+	dbll_index_t index
 ) {
 	if(
 		!dbll_state_valid(state) ||
+		!state_writable(state) ||
 		index < 0 ||
 		index >= state->file.size
 	) {
@@ -1858,18 +5737,13 @@ int dbll_size_index_copy(
 	}
 
 	int data_size = state->header.data_size;
-	index += data_size - 1;
-
-	// done manually and not with memcpy in order to enforce endianness
-	for(int i = 0; i < data_size && index >= 0; i++) {
-		state->file.mem[index] = (size >> (i * 8)) & 0xff;
-		index--;
-	}
+	uint8_t mem[DBLL_SIZE_MAX] = { 0 };
+	state->header.codec->size_put(mem, size);
 
-	return DBLL_OK;
+	return state_write(state, index, mem, data_size);
 }
 
-dbll_ptr_t dbll_index_to_ptr(dbll_state_t *state, int index) {
+dbll_ptr_t dbll_index_to_ptr(dbll_state_t *state, dbll_index_t index) {
 	if(
 		!dbll_state_valid(state) ||
 		index < 0 || 
@@ -1878,37 +5752,63 @@ dbll_ptr_t dbll_index_to_ptr(dbll_state_t *state, int index) {
 		return DBLL_NULL_ERR;
 	}
 
+	index -= state->header.header_size;
+	if(index < 0) {
+		return DBLL_NULL_ERR;
+	}
+
 	// convert to one-based indices because 0 is reserved
 	// and that dbll_ptr_t a one-based index system, so
 	// adjust accordingly
-	index++;
-	dbll_ptr_t result = (dbll_ptr_t)(index);
-	result -= state->header.header_size;
-	if(result < 0) {
-		return DBLL_NULL_ERR;
+	return index / state->header.block_size + 1;
+}
+
+dbll_index_t dbll_ptr_to_index(dbll_state_t *state, dbll_ptr_t ptr) {
+	if(!dbll_state_valid(state)) {
+		return -1;
 	}
 
-	result /= state->header.list_size;
-	return result;
+	return state_index(state, ptr);
 }
 
-int dbll_ptr_to_index(dbll_state_t *state, dbll_ptr_t ptr) {
+int dbll_cursor_load(
+	dbll_cursor_t *cursor,
+	dbll_state_t *state,
+	dbll_ptr_t ptr,
+	dbll_ptr_t *trail,
+	int trail_size
+) {
 	if(
+		cursor == NULL ||
 		!dbll_state_valid(state) ||
-		ptr == DBLL_NULL
+
+		// pool pages move around, there's no mapping to point into
+		state->file.flags & DBLL_OPEN_POOL ||
+		trail_size < 0 ||
+		state_index(state, ptr) < 0
 	) {
-		return -1;
+		return DBLL_ERR;
 	}
 
-	// because 0 is reserved, indices are one-based
-	// so ptr is subtracted to convert it back to
-	// zero-base in order for conversion to happen
-	ptr--;
-	int offset = state->header.header_size;
-	int index = offset + (ptr * state->header.list_size);
-	if(index < 0 || index >= state->file.size) {
-		return -1;
-	}
+	dbll_header_t *header = &state->header;
+	cursor->mem = state->file.mem;
+	cursor->blocks = (
+		state->file.mem + 
+		header->header_size - 
+		header->block_size
+	);
 
-	return index;
+	cursor->block_size = header->block_size;
+	cursor->block_shift = header->block_shift;
+	cursor->ptr_size = header->ptr_size;
+	cursor->kind_shift = header->kind_shift;
+	cursor->block_count = header->block_count;
+	cursor->ptr_get = header->codec->ptr_get;
+	cursor->size_get = header->codec->size_get;
+	cursor->ptr = ptr;
+	cursor->node = state->file.mem + state_index(state, ptr);
+	cursor->trail = trail;
+	cursor->trail_size = trail_size;
+	cursor->depth = 0;
+	return DBLL_OK;
 }
@@ -2,6 +2,7 @@
 #define DBLL_H
 	#include <stdint.h>
 	#include <stddef.h>
+	#include <sys/uio.h>
 	
 	// DBLL_OK and DBLL_ERR are used in functions that return an int
 	// for error handling, unless it's a function that uses int to return a bool
@@ -11,35 +12,266 @@
 	#define DBLL_PTR_MAX 8
 	#define DBLL_SIZE_MAX 4
 	#define DBLL_NULL 0
+
+	// the version new files are made with, it's kept in the top half
+	// of the data size byte. files from before there were versions
+	// have 0 there, they still load and dbll_state_convert upgrades them
+	#define DBLL_HEADER_VERSION 3
+
+	// the biggest a header can be, the version 3 one with pointers
+	// of DBLL_PTR_MAX, a flags byte, two 8 byte counts and a checksum
+	#define DBLL_HEADER_MAX (DBLL_MAGIC_SIZE + 2 + (DBLL_PTR_MAX * 3) + 21)
+
+	// size class n is a slot of 1 << n blocks in a row, slots of a
+	// class are made a slab of DBLL_CLASS_SLAB blocks at a time
+	#define DBLL_CLASS_COUNT 9
+	#define DBLL_CLASS_SLAB (1 << (DBLL_CLASS_COUNT - 1))
+
+	// data slots are allocated this many blocks at a time
+	#define DBLL_ALLOC_BATCH 1024
+
+	// the most bytes of data a list can hold itself, in its data
+	// pointer and size, all but the byte the kind and length are in
+	#define DBLL_INLINE_MAX (DBLL_PTR_MAX + DBLL_SIZE_MAX - 1)
+
+	// DBLL_FORMAT_ALIGNED pads the header out to this, so blocks
+	// start on a cache line
+	#define DBLL_CACHE_LINE 64
+
+	// dbll_state_alloc grows the file by at least this many blocks
+	// at a time, after that the capacity doubles every time it runs out
+	#define DBLL_GROW_MIN 64
+
+	// how much address space DBLL_OPEN_STABLE reserves up front,
+	// the file can grow up to this size without the mapping moving
+	#define DBLL_RESERVE_SIZE ((size_t)(1) << 36)
+
+	// reserved address space starts on a multiple of this,
+	// so DBLL_OPEN_HUGEPAGE mappings can use huge pages
+	#define DBLL_HUGEPAGE_SIZE ((size_t)(1) << 21)
+
+	// DBLL_OPEN_POOL keeps this many pages of this size in memory
+	#define DBLL_POOL_FRAMES 1024
+	#define DBLL_POOL_PAGE_SIZE 4096
+
+	// most reads the pool has in flight at once
+	#define DBLL_RING_ENTRIES 64
 	typedef uint64_t dbll_ptr_t;
 	typedef uint32_t dbll_size_t;
+
+	// an index into file memory (a byte in the file), or a size/offset
+	// of file memory. it's signed so -1 can still mean an error
+	typedef int64_t dbll_index_t;
+	typedef enum {
+		DBLL_OPEN_DEFAULT = 0,
+
+		// mem stays at the same address when the file grows,
+		// so pointers into it don't go stale
+		DBLL_OPEN_STABLE = 1 << 0,
+
+		// maps the file read only, anything that changes
+		// file memory errors
+		DBLL_OPEN_READONLY = 1 << 1,
+
+		// asks for transparent huge pages, which means
+		// less tlb misses going through big files. this
+		// also turns on DBLL_OPEN_STABLE so that file memory
+		// stays aligned to DBLL_HUGEPAGE_SIZE
+		DBLL_OPEN_HUGEPAGE = 1 << 2,
+
+		// doesn't map the file, pages are read and written with
+		// pread/pwrite through a buffer pool instead. this is for
+		// files bigger than memory, when what stays in memory
+		// needs to be under control. mem is null with this
+		DBLL_OPEN_POOL = 1 << 3
+	} dbll_open_e;
+
+	// flags for how blocks are stored, kept in the header
+	typedef enum {
+		DBLL_FORMAT_DEFAULT = 0,
+
+		// pointers and sizes in blocks are little endian
+		// instead of big endian. on little endian machines
+		// that's one memcpy per field instead of a shift
+		// and mask per byte
+		DBLL_FORMAT_NATIVE = 1 << 0,
+
+		// blocks are padded to a power of two and the header
+		// to DBLL_CACHE_LINE, so no block is split between
+		// two cache lines. data slots don't use the padding
+		DBLL_FORMAT_ALIGNED = 1 << 1
+	} dbll_format_e;
+
+	typedef struct {
+
+		// which page of the file is in this frame, -1 if none
+		dbll_index_t page;
+
+		// next frame in the same bucket, -1 if none
+		int next;
+
+		// pinned frames can't be evicted
+		int pin_count;
+
+		// reference bit for clock eviction
+		uint8_t is_used;
+		uint8_t is_dirty;
+	} dbll_pool_frame_t;
+
+	// an io_uring the pool submits batches of reads to. the
+	// pointers are into the rings the kernel shares with us
+	typedef struct {
+
+		// -1 if io_uring isn't there, reads use pread then
+		int desc;
+		unsigned entry_count;
+		uint8_t *sq_mem;
+		size_t sq_size;
+		uint8_t *cq_mem;
+		size_t cq_size;
+		uint8_t *sqes;
+		size_t sqes_size;
+		unsigned *sq_head;
+		unsigned *sq_tail;
+		unsigned *sq_mask;
+		unsigned *sq_array;
+		unsigned *cq_head;
+		unsigned *cq_tail;
+		unsigned *cq_mask;
+		uint8_t *cqes;
+	} dbll_ring_t;
+
+	typedef struct {
+
+		// frame_count pages of DBLL_POOL_PAGE_SIZE
+		uint8_t *mem;
+		dbll_pool_frame_t *frames;
+		int frame_count;
+
+		// hash table from a page to the first frame
+		// in its bucket, bucket_count is a power of two
+		int *buckets;
+		int bucket_count;
+
+		// where clock eviction looks next
+		int hand;
+		dbll_ring_t ring;
+	} dbll_pool_t;
+
 	typedef struct {
 		uint8_t *mem;
 		size_t size;
 		int desc;
+
+		// dbll_open_e flags given when the file was loaded
+		int flags;
+
+		// how much address space is reserved at mem, only
+		// used with DBLL_OPEN_STABLE
+		size_t reserve_size;
+
+		// only used with DBLL_OPEN_POOL
+		dbll_pool_t pool;
 	} dbll_file_t;
 
 	int dbll_file_valid(dbll_file_t *);
 	int dbll_file_load(dbll_file_t *, const char *);
+	int dbll_file_load_flags(
+		dbll_file_t *,
+		const char *,
+		int
+	);
+
 	int dbll_file_unload(dbll_file_t *);
 	int dbll_file_make(dbll_file_t *, const char *);
-	int dbll_file_resize(dbll_file_t *, int);
+	int dbll_file_resize(dbll_file_t *, dbll_index_t);
+	int dbll_file_sync(dbll_file_t *, int);
+	int dbll_file_read(
+		dbll_file_t *,
+		dbll_index_t,
+		uint8_t *,
+		dbll_index_t
+	);
+
+	int dbll_file_write(
+		dbll_file_t *,
+		dbll_index_t,
+		const uint8_t *,
+		dbll_index_t
+	);
+
+	int dbll_file_pin(
+		dbll_file_t *,
+		dbll_index_t,
+		uint8_t **
+	);
+
+	int dbll_file_unpin(dbll_file_t *, dbll_index_t);
+	int dbll_file_fetch(
+		dbll_file_t *,
+		const dbll_index_t *,
+		dbll_index_t,
+		dbll_index_t
+	);
+
+	struct dbll_codec_s;
 	typedef struct {
 		char magic[DBLL_MAGIC_SIZE];
 		uint8_t ptr_size;
 		uint8_t data_size;
+		uint8_t version;
+
+		// the last empty slot, dbll_state_load picks the empty
+		// slot list back up from here
 		dbll_ptr_t empty_slot_ptr;
 
+		// the rest of what's in the file is only there from version
+		// 2 on. the first empty slot, and flags for the format
+		dbll_ptr_t first_empty_ptr;
+		uint8_t flags;
+
+		// how many blocks fit in the file, spare capacity included
+		dbll_ptr_t capacity;
+
+		// only from version 3 on, the blocks that have the first free
+		// slot of every size class. it's null until one is needed
+		dbll_ptr_t class_ptr;
+
+		// fnv-1a of everything in the header that comes before it
+		uint32_t checksum;
+
+		// not in file, the functions that read and write fields and
+		// blocks for this pointer size, data size and format. they're
+		// picked once when the header is loaded
+		const struct dbll_codec_s *codec;
+
 		// not in file, computed in dbll_header_load
 		int header_size;
 
-		// list size is also the size of a block. this is an
-		// important detail to note, so take note of this
+		// list size is also the size of what's in a block. this
+		// is an important detail to note, so take note of this
 		int list_size;
 		int empty_slot_size;
 
+		// how far apart blocks are, list_size unless the format
+		// is DBLL_FORMAT_ALIGNED. block_shift is its log2 when
+		// it's a power of two, 0 otherwise
+		int block_size;
+		int block_shift;
+
+		// how far up a list's data size the data kind is, see
+		// dbll_data_e. older files have no kinds, the shift goes
+		// past the field so every list's data is a chain
+		int kind_shift;
+
 		// the size of "free" data in data_slot_t
 		int data_slot_size;
+
+		// the logical end of the blocks that are in use, only in the
+		// file from version 2 on. the file can be bigger than this,
+		// anything past it is spare capacity that dbll_state_alloc
+		// hands out without a resize
+		dbll_ptr_t block_count;
 	} dbll_header_t;
 
 	struct dbll_state_s;
@@ -50,6 +282,27 @@
 		struct dbll_state_s *
 	);
 	
+	// what a list's data is. it's kept in the top two bits of the
+	// data size in the file, only from version 2 on
+	typedef enum {
+
+		// data_ptr is the first block of a chain of data slots
+		DBLL_DATA_CHAIN = 0,
+
+		// data_ptr is the first of a run of blocks that come right
+		// after each other, the data goes straight through them
+		// with no pointers in between
+		DBLL_DATA_EXTENT = 1,
+
+		// data_ptr is a slot of the smallest size class that
+		// data_size fits in, it's like an extent otherwise
+		DBLL_DATA_CLASS = 2,
+
+		// the data is in the list itself, where the data pointer
+		// and size would be, see dbll_list_inline_get
+		DBLL_DATA_INLINE = 3
+	} dbll_data_e;
+
 	typedef struct {
 	
 		// to dbll_list_t
@@ -58,16 +311,54 @@
 		// to dbll_list_t
 		dbll_ptr_t tail_ptr;
 
-		// to int (file index), size is multiple of list structure size
+		// to the first block of the data chain
 		dbll_ptr_t data_ptr;
 
-		// data_size is multiples of list size
+		// how many bytes of data there are, the chain or run has
+		// as many blocks as it takes to hold them
 		dbll_size_t data_size;
 
+		// in the file it's part of data_size, here it's kept apart
+		dbll_data_e data_kind;
+
+		// the bytes of an inline value, in the file they're in the
+		// data pointer and size. data_ptr is null when they're here
+		uint8_t data_inline[DBLL_INLINE_MAX];
+
 		// not in data, used by library
 		dbll_ptr_t this_ptr;
+
+		// not in data, the last block of the data chain and the
+		// state's generation when it was found, so appending
+		// doesn't have to walk the chain every time
+		dbll_ptr_t data_tail_ptr;
+		uint64_t data_generation;
 	} dbll_list_t;
 
+	// an inline value is kept as what the data pointer and size fields
+	// are worth, a byte at a time from the lowest one up, so it's the
+	// same in either byte order. its length is in the 6 bits under the
+	// kind, ptr and size being the fields as they are in the file
+	static inline void dbll_list_inline_get(
+		dbll_list_t *list,
+		uint64_t ptr,
+		uint64_t size,
+		int ptr_size,
+		int kind_shift
+	) {
+		int size_size = (kind_shift + 2) / 8;
+		for(int i = 0; i < ptr_size; i++) {
+			list->data_inline[i] = ptr >> (i * 8);
+		}
+
+		for(int i = 0; i < size_size - 1; i++) {
+			list->data_inline[ptr_size + i] = size >> (i * 8);
+		}
+
+		list->data_ptr = DBLL_NULL;
+		list->data_size = (size >> (kind_shift - 6)) & 0x3f;
+	}
+
 	typedef enum {
 		DBLL_GO_HEAD,
 		DBLL_GO_TAIL
@@ -87,8 +378,23 @@
 		struct dbll_state_s *, 
 		list_go_e
 	);
+
+	// the same as the two above without checking the state or
+	// the list, only that the pointer is a block. the state has
+	// to have passed dbll_state_valid since it was last changed
+	int dbll_list_load_unchecked(
+		dbll_list_t *, 
+		struct dbll_state_s *, 
+		dbll_ptr_t
+	);
+
+	int dbll_list_go_unchecked(
+		dbll_list_t *, 
+		struct dbll_state_s *, 
+		list_go_e
+	);
 	
-	int dbll_list_data_index(
+	dbll_index_t dbll_list_data_index(
 		dbll_list_t *, 
 		struct dbll_state_s *
 	);
@@ -96,13 +402,21 @@
 	int dbll_list_data_alloc(
 		dbll_list_t *,
 		struct dbll_state_s *,
-		int
+		dbll_index_t blocks
+	);
+
+	// like dbll_list_data_alloc but the size is in bytes, and the
+	// data goes wherever that many bytes fit best
+	int dbll_list_data_alloc_bytes(
+		dbll_list_t *,
+		struct dbll_state_s *,
+		dbll_index_t size_bytes
 	);
 	
 	int dbll_list_data_resize(
 		dbll_list_t *,
 		struct dbll_state_s *,
-		int
+		dbll_index_t blocks
 	);
 
 	int dbll_list_write(
@@ -110,6 +424,51 @@
 		struct dbll_state_s *
 	);
 
+	int dbll_list_data_append(
+		dbll_list_t *,
+		struct dbll_state_s *,
+		const uint8_t *,
+		dbll_index_t
+	);
+
+	int dbll_list_data_alloc_extent(
+		dbll_list_t *,
+		struct dbll_state_s *,
+		dbll_index_t size_bytes
+	);
+
+	// these work on any kind of data
+	int dbll_list_data_read(
+		dbll_list_t *,
+		struct dbll_state_s *,
+		dbll_index_t,
+		uint8_t *,
+		dbll_index_t
+	);
+
+	int dbll_list_data_write(
+		dbll_list_t *,
+		struct dbll_state_s *,
+		dbll_index_t,
+		const uint8_t *,
+		dbll_index_t
+	);
+
+	int dbll_list_data_iov(
+		dbll_list_t *,
+		struct dbll_state_s *,
+		dbll_index_t,
+		dbll_index_t,
+		struct iovec *,
+		int
+	);
+
+	int dbll_list_prefetch(
+		dbll_list_t *,
+		struct dbll_state_s *,
+		dbll_index_t
+	);
+
 	typedef struct {
 
 		// to dbll_list_t
@@ -148,20 +507,31 @@
 		struct dbll_state_s *
 	);
 	
+	// which block every page of a data chain is in, so getting to a
+	// page doesn't mean walking the chain up to it. it's filled in as
+	// far as it's needed, and starts over when generation doesn't
+	// match the state's anymore
+	typedef struct dbll_page_table_s {
+		dbll_ptr_t *ptrs;
+		dbll_index_t count;
+		dbll_index_t capacity;
+		uint64_t generation;
+	} dbll_page_table_t;
+
 	typedef struct dbll_data_slot_s {
 		dbll_ptr_t next_ptr;
 
 		// not in data, used in library for
 		// converting a page index into a file index
-		int data_index;
+		dbll_index_t data_index;
 		
-		// not in data, used in library for 
-		// preventing cyclic loops
-		uint8_t is_marked;
-
 		// again, not in data, used in library
 		// for freeing data slots
 		dbll_ptr_t this_ptr;
+
+		// not in data, NULL unless the user gave the slot one with
+		// dbll_page_table_load, it's for the chain from this block on
+		dbll_page_table_t *table;
 	} dbll_data_slot_t;
 
 	int dbll_data_slot_valid(dbll_data_slot_t *);
@@ -182,22 +552,22 @@
 		struct dbll_state_s *
 	);
 	
-	int dbll_data_slot_page(
+	dbll_index_t dbll_data_slot_page(
 		dbll_data_slot_t *, 
 		struct dbll_state_s *, 
-		int
+		dbll_index_t
 	);
 
 	int dbll_data_slot_resize(
 		dbll_data_slot_t *,
 		struct dbll_state_s *,
-		int
+		dbll_index_t
 	);
 
 	int dbll_data_slot_alloc(
 		dbll_data_slot_t *,
 		struct dbll_state_s *,
-		int
+		dbll_index_t
 	);
 
 	int dbll_data_slot_write(
@@ -208,41 +578,126 @@
 	dbll_ptr_t dbll_data_slot_last(
 		dbll_data_slot_t *,
 		struct dbll_state_s *,
-		int *
+		dbll_index_t *
 	);
 
 	int dbll_data_slot_cut_end(
 		dbll_data_slot_t *,
 		struct dbll_state_s *,
-		int
+		dbll_index_t
 	);
 
 	int dbll_data_slot_write_mem(
 		dbll_data_slot_t *,
 		struct dbll_state_s *,
-		int,
+		dbll_index_t,
 		uint8_t *,
-		int
+		dbll_index_t
 	);
 
 	int dbll_data_slot_read_mem(
 		dbll_data_slot_t *,
 		struct dbll_state_s *,
-		int,
+		dbll_index_t,
 		uint8_t *,
+		dbll_index_t
+	);
+
+	int dbll_data_slot_iov(
+		dbll_data_slot_t *,
+		struct dbll_state_s *,
+		dbll_index_t,
+		dbll_index_t,
+		struct iovec *,
 		int
 	);
+
+	int dbll_page_table_load(dbll_page_table_t *, dbll_data_slot_t *);
+	int dbll_page_table_unload(dbll_page_table_t *);
 	
+	typedef enum {
+
+		// only syncs on dbll_state_sync and on unload
+		DBLL_SYNC_EXPLICIT,
+
+		// never syncs, not even on unload, the kernel
+		// writes things back whenever it wants to
+		DBLL_SYNC_NONE,
+
+		// starts writing back without waiting for it when
+		// the file grows, on commit and on unload
+		DBLL_SYNC_ASYNC,
+
+		// like DBLL_SYNC_EXPLICIT, but every dbll_state_commit
+		// waits for everything to be written back too
+		DBLL_SYNC_COMMIT
+	} dbll_sync_e;
+
+	typedef enum {
+		DBLL_ADVISE_NORMAL,
+
+		// pointer chasing, like going through a tree
+		DBLL_ADVISE_RANDOM,
+
+		// going through blocks in order, like compacting
+		DBLL_ADVISE_SEQUENTIAL,
+
+		// going to be used soon, so start reading it in
+		DBLL_ADVISE_WILLNEED,
+
+		// not going to be used for a while
+		DBLL_ADVISE_DONTNEED
+	} dbll_advise_e;
+
 	typedef struct dbll_state_s {
 		dbll_file_t file;
 		dbll_header_t header;
 		dbll_empty_slot_t last_empty;
 		dbll_list_t root_list;
+		dbll_sync_e sync;
+
+		// one bit per page of file memory that was written to
+		// since the last dbll_state_sync, dirty_size is in bytes
+		uint8_t *dirty;
+		size_t dirty_size;
+
+		// goes up whenever a data chain might have changed shape,
+		// a page table from before that is out of date
+		uint64_t generation;
 	} dbll_state_t;
 
 	int dbll_state_valid(dbll_state_t *);
 	int dbll_state_load(dbll_state_t *, const char *);
+	int dbll_state_load_flags(
+		dbll_state_t *,
+		const char *,
+		int
+	);
+
+	int dbll_state_load_readonly(dbll_state_t *, const char *);
 	int dbll_state_unload(dbll_state_t *);
+	int dbll_state_sync_policy(dbll_state_t *, dbll_sync_e);
+	int dbll_state_sync(dbll_state_t *);
+	int dbll_state_dirty(
+		dbll_state_t *,
+		dbll_index_t,
+		dbll_index_t
+	);
+
+	int dbll_state_commit(dbll_state_t *);
+	int dbll_state_fetch(
+		dbll_state_t *,
+		const dbll_ptr_t *,
+		dbll_index_t
+	);
+
+	int dbll_state_advise(
+		dbll_state_t *,
+		dbll_ptr_t,
+		dbll_ptr_t,
+		dbll_advise_e
+	);
+
 	int dbll_state_make(dbll_state_t *, const char *);
 	int dbll_state_make_replace(
 		dbll_state_t *,
@@ -251,38 +706,232 @@
 	
 	dbll_ptr_t dbll_state_empty_find(dbll_state_t *);
 	dbll_ptr_t dbll_state_alloc(dbll_state_t *);
+
+	// gives count blocks that come right after each other and returns
+	// the first one, empty blocks at the end of the file get used up
+	// first and the rest come from growing it
+	dbll_ptr_t dbll_state_alloc_run(dbll_state_t *, dbll_ptr_t);
+
+	typedef enum {
+		DBLL_ALLOC_DEFAULT = 0,
+
+		// the blocks come one after another, from
+		// dbll_state_alloc_run
+		DBLL_ALLOC_CONTIGUOUS = 1 << 0
+	} dbll_alloc_e;
+
+	// n blocks into out, with dbll_alloc_e flags. empty slots are used
+	// first, the rest come from one grow of the file
+	int dbll_state_alloc_n(
+		dbll_state_t *, 
+		dbll_ptr_t, 
+		dbll_ptr_t *, 
+		int
+	);
+
 	int dbll_state_mark_free(dbll_state_t *, dbll_ptr_t);
 	int dbll_state_total_size(
 		dbll_state_t *,
-		int *
+		dbll_ptr_t *
 	);
 
 	int dbll_state_trim(dbll_state_t *);
 	int dbll_state_compact(dbll_state_t *);
+	int dbll_state_convert(dbll_state_t *, int);
 	int dbll_index_ptr_copy(
 		dbll_state_t *,
-		int,
+		dbll_index_t,
 		dbll_ptr_t *
 	);
 
 	int dbll_index_size_copy(
 		dbll_state_t *,
-		int,
+		dbll_index_t,
 		dbll_size_t *
 	);
 
 	int dbll_ptr_index_copy(
 		dbll_state_t *, 
 		dbll_ptr_t,
-		int
+		dbll_index_t
 	);
 
 	int dbll_size_index_copy(
 		dbll_state_t *,
 		dbll_size_t,
-		int
+		dbll_index_t
 	);
 	
-	dbll_ptr_t dbll_index_to_ptr(dbll_state_t *, int);
-	int dbll_ptr_to_index(dbll_state_t *, dbll_ptr_t);
+	dbll_ptr_t dbll_index_to_ptr(dbll_state_t *, dbll_index_t);
+	dbll_index_t dbll_ptr_to_index(dbll_state_t *, dbll_ptr_t);
+
+	// a cursor keeps what it takes to find a block in the mapping so
+	// going down a tree is a few loads a level. it only works with
+	// mapped files, and the mapping has to stay where it is, so load
+	// it again after anything that grows the file unless the file was
+	// opened with DBLL_OPEN_STABLE
+	typedef struct {
+
+		// where block 0 would be if there was one, so block ptr
+		// starts at blocks + ptr * block_size
+		const uint8_t *blocks;
+
+		// the start of the mapping, for working out file indexes
+		const uint8_t *mem;
+		dbll_index_t block_size;
+		int block_shift;
+		int ptr_size;
+		int kind_shift;
+		dbll_ptr_t block_count;
+		uint64_t (*ptr_get)(const uint8_t *);
+		uint64_t (*size_get)(const uint8_t *);
+
+		// the list the cursor is on and where it starts in memory
+		dbll_ptr_t ptr;
+		const uint8_t *node;
+
+		// the breadcrumbs for dbll_cursor_up, given by the user
+		// and NULL if going back up isn't needed
+		dbll_ptr_t *trail;
+		int trail_size;
+		int depth;
+	} dbll_cursor_t;
+
+	int dbll_cursor_load(
+		dbll_cursor_t *,
+		dbll_state_t *,
+		dbll_ptr_t,
+		dbll_ptr_t *,
+		int
+	);
+
+	// nothing gets checked past the pointer being a block, the
+	// state was checked when the cursor was loaded
+	static inline const uint8_t *dbll_cursor_block(
+		dbll_cursor_t *cursor,
+		dbll_ptr_t ptr
+	) {
+		if(ptr == DBLL_NULL || ptr > cursor->block_count) {
+			return NULL;
+		}
+
+		return cursor->block_shift > 0
+			? cursor->blocks + (ptr << cursor->block_shift)
+			: cursor->blocks + (ptr * cursor->block_size);
+	}
+
+	// moves onto the list at the field offset (in pointers) of
+	// the current one
+	static inline int dbll_cursor_move(
+		dbll_cursor_t *cursor,
+		int field
+	) {
+		dbll_ptr_t ptr = cursor->ptr_get(
+			cursor->node + 
+			(field * cursor->ptr_size)
+		);
+
+		const uint8_t *node = dbll_cursor_block(cursor, ptr);
+		if(node == NULL) {
+			return DBLL_ERR;
+		}
+
+		if(cursor->trail != NULL) {
+			if(cursor->depth >= cursor->trail_size) {
+				return DBLL_ERR;
+			}
+
+			cursor->trail[cursor->depth] = cursor->ptr;
+			cursor->depth++;
+		}
+
+		cursor->ptr = ptr;
+		cursor->node = node;
+		return DBLL_OK;
+	}
+
+	static inline int dbll_cursor_head(dbll_cursor_t *cursor) {
+		return dbll_cursor_move(cursor, 0);
+	}
+
+	static inline int dbll_cursor_tail(dbll_cursor_t *cursor) {
+		return dbll_cursor_move(cursor, 1);
+	}
+
+	// goes back to the list the last head or tail came from
+	static inline int dbll_cursor_up(dbll_cursor_t *cursor) {
+		if(cursor->trail == NULL || cursor->depth <= 0) {
+			return DBLL_ERR;
+		}
+
+		cursor->depth--;
+		cursor->ptr = cursor->trail[cursor->depth];
+		cursor->node = dbll_cursor_block(cursor, cursor->ptr);
+		return DBLL_OK;
+	}
+
+	// loads the current list's first data slot, the cursor stays
+	// where it is. only chains have data slots, any other kind of
+	// data errors, there's no pointer in its fields
+	static inline int dbll_cursor_data(
+		dbll_cursor_t *cursor,
+		dbll_data_slot_t *slot
+	) {
+		uint64_t data_size = cursor->size_get(
+			cursor->node + 
+			(cursor->ptr_size * 3)
+		);
+
+		if((data_size >> cursor->kind_shift) != DBLL_DATA_CHAIN) {
+			return DBLL_ERR;
+		}
+
+		dbll_ptr_t ptr = cursor->ptr_get(
+			cursor->node + 
+			(cursor->ptr_size * 2)
+		);
+
+		const uint8_t *block = dbll_cursor_block(cursor, ptr);
+		if(block == NULL) {
+			return DBLL_ERR;
+		}
+
+		slot->next_ptr = cursor->ptr_get(block);
+		slot->data_index = (block - cursor->mem) + cursor->ptr_size;
+		slot->this_ptr = ptr;
+		slot->table = NULL;
+		return DBLL_OK;
+	}
+
+	static inline void dbll_cursor_list(
+		dbll_cursor_t *cursor,
+		dbll_list_t *list
+	) {
+		int ptr_size = cursor->ptr_size;
+		list->head_ptr = cursor->ptr_get(cursor->node);
+		list->tail_ptr = cursor->ptr_get(cursor->node + ptr_size);
+		list->data_ptr = cursor->ptr_get(cursor->node + (ptr_size * 2));
+		uint64_t data_size = cursor->size_get(
+			cursor->node + 
+			(ptr_size * 3)
+		);
+
+		list->data_kind = data_size >> cursor->kind_shift;
+		list->data_size = data_size & 
+			(((uint64_t)(1) << cursor->kind_shift) - 1);
+
+		if(list->data_kind == DBLL_DATA_INLINE) {
+			dbll_list_inline_get(
+				list,
+				list->data_ptr,
+				data_size,
+				ptr_size,
+				cursor->kind_shift
+			);
+		}
+
+		list->this_ptr = cursor->ptr;
+		list->data_tail_ptr = DBLL_NULL;
+		list->data_generation = 0;
+	}
 #endif
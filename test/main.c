@@ -1,4 +1,9 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include <test.h>
 #include <dbll.h>
 
@@ -67,6 +72,2421 @@ int test_mark_free() {
 	return TEST_PASS;
 }
 
+// freed blocks have to be handed out again after reopening the file,
+// instead of the file growing
+int test_free_reload() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-free-reload.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_ptr_t ptrs[8] = { 0 };
+		for(int i = 0; i < 8; i++) {
+			ptrs[i] = dbll_state_alloc(&state);
+			if(ptrs[i] == DBLL_NULL) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		}
+
+		if(
+			dbll_state_mark_free(&state, ptrs[2]) < 0 ||
+			dbll_state_mark_free(&state, ptrs[5]) < 0 ||
+			dbll_state_mark_free(&state, ptrs[6]) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	if(dbll_state_load(&state, "db/test-free-reload.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_ptr_t total_size = 0;
+		if(
+			state.last_empty.this_ptr != ptrs[6] ||
+			state.header.first_empty_ptr != ptrs[2] ||
+			dbll_state_alloc(&state) != ptrs[6] ||
+			dbll_state_alloc(&state) != ptrs[5] ||
+			dbll_state_alloc(&state) != ptrs[2] ||
+			state.header.first_empty_ptr != DBLL_NULL ||
+			dbll_state_total_size(&state, &total_size) < 0 ||
+			total_size != 9
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// reused blocks come back zeroed like new ones
+		dbll_list_t list = { 0 };
+		if(
+			dbll_list_load(&list, &state, ptrs[2]) < 0 ||
+			list.head_ptr != DBLL_NULL ||
+			list.tail_ptr != DBLL_NULL
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	// a header that doesn't match its checksum doesn't load
+	FILE *file = fopen("db/test-free-reload.dbll", "r+b");
+	if(
+		file == NULL ||
+		fseek(file, DBLL_MAGIC_SIZE + 2, SEEK_SET) < 0 ||
+		fputc(0xff, file) == EOF ||
+		fclose(file) == EOF
+	) {
+		return TEST_FAIL_ERR;
+	}
+
+	if(dbll_state_load(&state, "db/test-free-reload.dbll") >= 0) {
+		dbll_state_unload(&state);
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_alloc_grow() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-alloc-grow.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+		// the file should only be resized a handful of times,
+		// not once per block
+		int resize_count = 0;
+		size_t last_size = state.file.size;
+		for(int i = 0; i < 1000; i++) {
+			dbll_ptr_t new_list = dbll_state_alloc(&state);
+			if(new_list != (dbll_ptr_t)(i + 2)) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+
+			if(state.file.size != last_size) {
+				last_size = state.file.size;
+				resize_count++;
+			}
+		}
+
+		dbll_ptr_t total_size = 0;
+		if(
+			dbll_state_total_size(&state, &total_size) < 0 ||
+			total_size != 1001 ||
+			resize_count > 10
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	// spare capacity stays in the file, the header knows
+	// where the blocks end
+	struct stat file_stat = { 0 };
+	if(
+		stat("db/test-alloc-grow.dbll", &file_stat) < 0 ||
+		dbll_state_load(&state, "db/test-alloc-grow.dbll") < 0
+	) {
+		return TEST_FAIL_ERR;
+	}
+		if(
+			dbll_state_total_size(&state, &total_size) < 0 ||
+			total_size != 1001 ||
+			state.header.capacity <= total_size ||
+			file_stat.st_size != (
+				state.header.header_size +
+				state.header.capacity * state.header.list_size
+			)
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_stable_map() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-stable-map.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	if(
+		dbll_state_load_flags(
+			&state, 
+			"db/test-stable-map.dbll",
+			DBLL_OPEN_STABLE
+		) < 0
+	) {
+		return TEST_FAIL_ERR;
+	}
+		uint8_t *mem = state.file.mem;
+		dbll_ptr_t new_list = DBLL_NULL;
+		for(int i = 0; i < 10000; i++) {
+			new_list = dbll_state_alloc(&state);
+			if(new_list == DBLL_NULL || state.file.mem != mem) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		}
+
+		dbll_list_t list = { 0 };
+		list.this_ptr = new_list;
+		list.head_ptr = 1;
+		if(
+			dbll_list_write(&list, &state) < 0 ||
+			dbll_list_load(&list, &state, new_list) < 0 ||
+			list.head_ptr != 1
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_sync_policy() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-sync-policy.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		const dbll_sync_e policies[] = {
+			DBLL_SYNC_NONE,
+			DBLL_SYNC_ASYNC,
+			DBLL_SYNC_COMMIT,
+			DBLL_SYNC_EXPLICIT
+		};
+
+		for(int i = 0; i < ARRAY_SIZE(policies); i++) {
+			if(dbll_state_sync_policy(&state, policies[i]) < 0) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+
+			for(int j = 0; j < 1000; j++) {
+				if(dbll_state_alloc(&state) == DBLL_NULL) {
+					dbll_state_unload(&state);
+					return TEST_FAIL_ERR;
+				}
+			}
+
+			if(dbll_state_commit(&state) < 0) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		}
+
+		if(
+			dbll_state_sync(&state) < 0 ||
+			dbll_state_sync_policy(&state, -1) >= 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+static int dirty_page_count(dbll_state_t *state) {
+	int count = 0;
+	for(int i = 0; i < state->dirty_size * 8; i++) {
+		count += (state->dirty[i / 8] >> (i % 8)) & 1;
+	}
+
+	return count;
+}
+
+int test_dirty_pages() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-dirty-pages.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_ptr_t new_list = DBLL_NULL;
+		for(int i = 0; i < 1000; i++) {
+			new_list = dbll_state_alloc(&state);
+			if(new_list == DBLL_NULL) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		}
+
+		if(dbll_state_sync(&state) < 0) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// one list is written, so only its page needs syncing
+		dbll_list_t list = { 0 };
+		list.this_ptr = new_list;
+		list.head_ptr = 1;
+		if(
+			dbll_list_write(&list, &state) < 0 ||
+			dirty_page_count(&state) != 1
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		if(
+			dbll_state_sync(&state) < 0 ||
+			dirty_page_count(&state) != 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+// the file is sparse, so this doesn't actually use up 3gb
+int test_large_file() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-large-file.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_index_t large_size = (dbll_index_t)(3) << 30;
+		if(dbll_file_resize(&state.file, large_size) < 0) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// past where an int would overflow
+		dbll_index_t index = large_size - state.header.list_size;
+		dbll_ptr_t ptr = DBLL_NULL;
+		dbll_ptr_t large_ptr = 0xdeadbeef;
+		if(
+			dbll_ptr_index_copy(&state, large_ptr, index) < 0 ||
+			dbll_index_ptr_copy(&state, index, &ptr) < 0 ||
+			ptr != large_ptr
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		dbll_ptr_t index_ptr = dbll_index_to_ptr(&state, index);
+		if(
+			index_ptr == DBLL_NULL ||
+			index_ptr * state.header.list_size < ((dbll_index_t)(1) << 31)
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// real blocks past 2 GiB, a list at the end of them and its
+		// data after that, both written, synced and read back
+		dbll_index_t large_index = (dbll_index_t)(1) << 31;
+		dbll_ptr_t run_count = large_index / state.header.block_size + 16;
+		dbll_ptr_t run_ptr = dbll_state_alloc_run(&state, run_count);
+		dbll_list_t list = { 0 };
+		if(
+			run_ptr == DBLL_NULL ||
+			dbll_list_load(&list, &state, run_ptr + run_count - 1) < 0 ||
+			dbll_list_data_index(&list, &state) >= 0 ||
+			dbll_ptr_to_index(&state, list.this_ptr) < large_index
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		const char *data = "past where an int would overflow";
+		list.head_ptr = run_ptr;
+		list.tail_ptr = run_ptr + run_count - 2;
+		if(
+			dbll_list_write(&list, &state) < 0 ||
+			dbll_list_data_alloc(&list, &state, 3) < 0 ||
+			dbll_list_data_index(&list, &state) < large_index ||
+			dbll_list_data_write(
+				&list, 
+				&state, 
+				0, 
+				(uint8_t *)(data), 
+				strlen(data) + 1
+			) < 0 ||
+
+			dbll_state_sync(&state) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		large_ptr = list.this_ptr;
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	if(dbll_state_load(&state, "db/test-large-file.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		char mem[64] = { 0 };
+		if(
+			dbll_list_load(&list, &state, large_ptr) < 0 ||
+			list.head_ptr != run_ptr ||
+			list.tail_ptr != large_ptr - 1 ||
+			dbll_list_data_read(
+				&list, 
+				&state, 
+				0, 
+				(uint8_t *)(mem), 
+				strlen(data) + 1
+			) < 0 ||
+
+			strcmp(mem, data) != 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_readonly() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-readonly.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	// any amount of readers can share the same file
+	dbll_state_t other_state = { 0 };
+	if(
+		dbll_state_load_readonly(&state, "db/test-readonly.dbll") < 0 ||
+		dbll_state_load_readonly(&other_state, "db/test-readonly.dbll") < 0
+	) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_list_t list = { 0 };
+		if(
+			dbll_list_load(&list, &other_state, 1) < 0 ||
+			dbll_state_alloc(&state) != DBLL_NULL ||
+			dbll_list_write(&state.root_list, &state) >= 0 ||
+			dbll_file_resize(&state.file, 16) >= 0
+		) {
+			dbll_state_unload(&state);
+			dbll_state_unload(&other_state);
+			return TEST_FAIL_ERR;
+		}
+	if(
+		dbll_state_unload(&state) < 0 ||
+		dbll_state_unload(&other_state) < 0
+	) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+// makes a new list with the given head and tail
+static dbll_ptr_t list_make(
+	dbll_state_t *state,
+	dbll_ptr_t head_ptr,
+	dbll_ptr_t tail_ptr
+) {
+	dbll_list_t list = { 0 };
+	list.this_ptr = dbll_state_alloc(state);
+	list.head_ptr = head_ptr;
+	list.tail_ptr = tail_ptr;
+	if(
+		list.this_ptr == DBLL_NULL ||
+		dbll_list_write(&list, state) < 0
+	) {
+		return DBLL_NULL;
+	}
+
+	return list.this_ptr;
+}
+
+// makes a full binary tree of the given depth, returns its root
+static dbll_ptr_t tree_make(dbll_state_t *state, int depth) {
+	if(depth <= 0) {
+		return DBLL_NULL;
+	}
+
+	dbll_ptr_t head_ptr = tree_make(state, depth - 1);
+	dbll_ptr_t tail_ptr = tree_make(state, depth - 1);
+	return list_make(state, head_ptr, tail_ptr);
+}
+
+int test_prefetch() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-prefetch.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_list_t list = { 0 };
+		dbll_ptr_t root_ptr = tree_make(&state, 12);
+		if(
+			root_ptr == DBLL_NULL ||
+			dbll_list_load(&list, &state, root_ptr) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		if(
+			dbll_state_advise(
+				&state, 
+				DBLL_NULL, 
+				0, 
+				DBLL_ADVISE_RANDOM
+			) < 0 ||
+
+			dbll_state_advise(
+				&state, 
+				root_ptr, 
+				1, 
+				DBLL_ADVISE_WILLNEED
+			) < 0 ||
+
+			dbll_list_prefetch(&list, &state, 3) < 0 ||
+			dbll_list_prefetch(&list, &state, -1) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+// counts the lists in a tree made by tree_make
+static dbll_ptr_t tree_count(dbll_state_t *state, dbll_ptr_t ptr) {
+	if(ptr == DBLL_NULL) {
+		return 0;
+	}
+
+	dbll_list_t list = { 0 };
+	if(dbll_list_load(&list, state, ptr) < 0) {
+		return 0;
+	}
+
+	return (
+		1 + 
+		tree_count(state, list.head_ptr) + 
+		tree_count(state, list.tail_ptr)
+	);
+}
+
+// the tree is bigger than the pool, so pages have to be evicted
+// and read back in for the counts to match
+int test_pool() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-pool.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	int depth = 19;
+	dbll_ptr_t list_count = ((dbll_ptr_t)(1) << depth) - 1;
+	if(
+		dbll_state_load_flags(
+			&state, 
+			"db/test-pool.dbll", 
+			DBLL_OPEN_POOL
+		) < 0
+	) {
+		return TEST_FAIL_ERR;
+	}
+		state.root_list.head_ptr = tree_make(&state, depth);
+		if(
+			state.root_list.head_ptr == DBLL_NULL ||
+			dbll_list_write(&state.root_list, &state) < 0 ||
+			tree_count(&state, state.root_list.head_ptr) != list_count
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		uint8_t *mem = NULL;
+		dbll_index_t index = dbll_ptr_to_index(&state, 1);
+		if(
+			dbll_file_pin(&state.file, index, &mem) < 0 ||
+			mem == NULL ||
+			tree_count(&state, state.root_list.head_ptr) != list_count ||
+			dbll_file_unpin(&state.file, index) < 0 ||
+			dbll_file_unpin(&state.file, index) >= 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	// everything the pool held has to be in the file now
+	if(dbll_state_load(&state, "db/test-pool.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		if(tree_count(&state, state.root_list.head_ptr) != list_count) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+// the tree is read back in batches, first every block at once and then
+// one level at a time, the counts only match if the batches read right
+int test_fetch() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-fetch.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	int depth = 15;
+	dbll_ptr_t list_count = ((dbll_ptr_t)(1) << depth) - 1;
+		state.root_list.head_ptr = tree_make(&state, depth);
+		if(
+			state.root_list.head_ptr == DBLL_NULL ||
+			dbll_list_write(&state.root_list, &state) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	int flags[] = { DBLL_OPEN_POOL, DBLL_OPEN_DEFAULT };
+	for(int i = 0; i < 2; i++) {
+		if(dbll_state_load_flags(&state, "db/test-fetch.dbll", flags[i]) < 0) {
+			return TEST_FAIL_ERR;
+		}
+			dbll_ptr_t *ptrs = malloc(list_count * sizeof(dbll_ptr_t));
+			if(ptrs == NULL) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+
+			// backwards so the batch isn't in file order
+			for(dbll_ptr_t j = 0; j < list_count; j++) {
+				ptrs[j] = list_count + 1 - j;
+			}
+
+			dbll_ptr_t bad_ptr = state.header.block_count + 1;
+			int result = (
+				dbll_state_fetch(&state, ptrs, list_count) < 0 ||
+				dbll_state_fetch(&state, &bad_ptr, 1) >= 0 ||
+				tree_count(&state, state.root_list.head_ptr) != list_count ||
+				dbll_list_prefetch(&state.root_list, &state, -1) < 0 ||
+				tree_count(&state, state.root_list.head_ptr) != list_count
+			);
+
+			free(ptrs);
+			if(result) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		if(dbll_state_unload(&state) < 0) {
+			return TEST_FAIL_ERR;
+		}
+	}
+
+	return TEST_PASS;
+}
+
+// counts the tree and reads back the data of the root list
+static int convert_check(
+	dbll_state_t *state, 
+	dbll_ptr_t list_count, 
+	const char *data
+) {
+	char mem[32] = { 0 };
+	dbll_data_slot_t slot = { 0 };
+	return (
+		tree_count(state, state->root_list.head_ptr) == list_count &&
+		dbll_data_slot_load(&slot, state, state->root_list.data_ptr) >= 0 &&
+		dbll_data_slot_read_mem(
+			&slot, 
+			state, 
+			0, 
+			(uint8_t *)(mem), 
+			strlen(data) + 1
+		) >= 0 &&
+
+		strcmp(mem, data) == 0
+	);
+}
+
+// everything has to read the same after converting, and after
+// reopening the converted file
+int test_convert() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-convert.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	int depth = 8;
+	dbll_ptr_t list_count = ((dbll_ptr_t)(1) << depth) - 1;
+	const char *data = "hello, there!";
+	dbll_ptr_t free_ptrs[2] = { 0 };
+		dbll_data_slot_t slot = { 0 };
+		state.root_list.head_ptr = tree_make(&state, depth);
+		free_ptrs[0] = dbll_state_alloc(&state);
+		free_ptrs[1] = dbll_state_alloc(&state);
+		if(
+			state.root_list.head_ptr == DBLL_NULL ||
+			dbll_list_write(&state.root_list, &state) < 0 ||
+			dbll_list_data_resize(&state.root_list, &state, 3) < 0 ||
+			dbll_data_slot_load(
+				&slot, 
+				&state, 
+				state.root_list.data_ptr
+			) < 0 ||
+
+			dbll_data_slot_write_mem(
+				&slot, 
+				&state, 
+				0, 
+				(uint8_t *)(data), 
+				strlen(data) + 1
+			) < 0 ||
+
+			dbll_state_mark_free(&state, free_ptrs[0]) < 0 ||
+			dbll_state_mark_free(&state, free_ptrs[1]) < 0 ||
+			dbll_state_convert(&state, DBLL_FORMAT_NATIVE) < 0 ||
+			!convert_check(&state, list_count, data)
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	if(dbll_state_load(&state, "db/test-convert.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		if(
+			state.header.flags != DBLL_FORMAT_NATIVE ||
+			!convert_check(&state, list_count, data) ||
+			dbll_state_convert(&state, DBLL_FORMAT_DEFAULT) < 0 ||
+			!convert_check(&state, list_count, data) ||
+			dbll_state_alloc(&state) != free_ptrs[1] ||
+			dbll_state_alloc(&state) != free_ptrs[0]
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+// every block has to start on a multiple of its size after aligning,
+// and read the same as before, in both formats
+int test_aligned() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-aligned.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	int depth = 8;
+	dbll_ptr_t list_count = ((dbll_ptr_t)(1) << depth) - 1;
+	const char *data = "hello, there!";
+		dbll_data_slot_t slot = { 0 };
+		state.root_list.head_ptr = tree_make(&state, depth);
+		if(
+			state.root_list.head_ptr == DBLL_NULL ||
+			dbll_list_write(&state.root_list, &state) < 0 ||
+			dbll_list_data_resize(&state.root_list, &state, 3) < 0 ||
+			dbll_data_slot_load(
+				&slot, 
+				&state, 
+				state.root_list.data_ptr
+			) < 0 ||
+
+			dbll_data_slot_write_mem(
+				&slot, 
+				&state, 
+				0, 
+				(uint8_t *)(data), 
+				strlen(data) + 1
+			) < 0 ||
+
+			dbll_state_convert(&state, DBLL_FORMAT_ALIGNED) < 0 ||
+			state.header.header_size != DBLL_CACHE_LINE ||
+			dbll_ptr_to_index(&state, 7) % state.header.block_size != 0 ||
+			!convert_check(&state, list_count, data)
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	if(dbll_state_load(&state, "db/test-aligned.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		if(
+			state.header.flags != DBLL_FORMAT_ALIGNED ||
+			!convert_check(&state, list_count, data) ||
+			dbll_state_convert(
+				&state, 
+				DBLL_FORMAT_ALIGNED | DBLL_FORMAT_NATIVE
+			) < 0 ||
+
+			!convert_check(&state, list_count, data) ||
+			dbll_state_convert(&state, DBLL_FORMAT_DEFAULT) < 0 ||
+			state.header.block_size != state.header.list_size ||
+			!convert_check(&state, list_count, data)
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	// 9 byte lists get padded to 16, the defaults are already a power
+	// of two so this is the only way to see blocks really move. it's a
+	// version 2 header with 3 blocks and the checksum worked out by hand
+	const uint8_t file_mem[] = {
+		'd', 'b', 'l', 'l', 2, 0x23, 
+		0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 3,
+		0, 0, 0, 0, 0, 0, 0, 3,
+		7, 152, 13, 144,
+		0, 2, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 3, 0, 0, 1, 2, 3,
+		0, 0, 0, 0, 0, 0, 0, 0, 0
+	};
+
+	FILE *file = fopen("db/test-aligned.dbll", "wb");
+	if(
+		file == NULL ||
+		fwrite(file_mem, sizeof(file_mem), 1, file) != 1 ||
+		fclose(file) == EOF
+	) {
+		return TEST_FAIL_ERR;
+	}
+
+	if(dbll_state_load(&state, "db/test-aligned.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_list_t list = { 0 };
+		if(
+			dbll_state_convert(&state, DBLL_FORMAT_ALIGNED) < 0 ||
+			state.header.version != DBLL_HEADER_VERSION ||
+			state.header.block_size != 16 ||
+			state.header.block_shift != 4 ||
+			dbll_list_load(&list, &state, 2) < 0 ||
+			list.tail_ptr != 3 ||
+			list.data_size != 0x010203 ||
+			dbll_state_convert(&state, DBLL_FORMAT_DEFAULT) < 0 ||
+			state.header.block_size != 9 ||
+			dbll_list_load(&list, &state, 2) < 0 ||
+			list.tail_ptr != 3 ||
+			list.data_size != 0x010203
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_unchecked() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-unchecked.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_ptr_t root_ptr = tree_make(&state, 10);
+		if(root_ptr == DBLL_NULL) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// both ways down have to end up on the same lists
+		dbll_list_t list = { 0 };
+		dbll_list_t checked = { 0 };
+		for(int i = 0; i < 64; i++) {
+			if(
+				dbll_list_load_unchecked(&list, &state, root_ptr) < 0 ||
+				dbll_list_load(&checked, &state, root_ptr) < 0
+			) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+
+			for(int level = 0; list.head_ptr != DBLL_NULL; level++) {
+				list_go_e go = (i >> level) & 1
+					? DBLL_GO_HEAD
+					: DBLL_GO_TAIL;
+
+				if(
+					dbll_list_go_unchecked(&list, &state, go) < 0 ||
+					dbll_list_go(&checked, &state, go) < 0 ||
+					memcmp(&list, &checked, sizeof(list)) != 0
+				) {
+					dbll_state_unload(&state);
+					return TEST_FAIL_ERR;
+				}
+			}
+		}
+
+		// the pointer is still checked
+		if(
+			dbll_list_go_unchecked(&list, &state, DBLL_GO_HEAD) >= 0 ||
+			dbll_list_load_unchecked(
+				&list, 
+				&state, 
+				state.header.block_count + 1
+			) >= 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_cursor() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-cursor.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_list_t root = { 0 };
+		dbll_ptr_t root_ptr = tree_make(&state, 10);
+		if(
+			root_ptr == DBLL_NULL ||
+			dbll_list_load(&root, &state, root_ptr) < 0 ||
+			dbll_list_data_resize(&root, &state, 2) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		dbll_ptr_t trail[16] = { 0 };
+		dbll_cursor_t cursor = { 0 };
+		dbll_list_t list = { 0 };
+		dbll_list_t checked = { 0 };
+		for(int i = 0; i < 64; i++) {
+			if(
+				dbll_cursor_load(
+					&cursor, 
+					&state, 
+					root_ptr, 
+					trail, 
+					ARRAY_SIZE(trail)
+				) < 0 ||
+
+				dbll_list_load(&checked, &state, root_ptr) < 0
+			) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+
+			for(int level = 0; checked.head_ptr != DBLL_NULL; level++) {
+				int is_head = (i >> level) & 1;
+				int result = is_head
+					? dbll_cursor_head(&cursor)
+					: dbll_cursor_tail(&cursor);
+
+				dbll_cursor_list(&cursor, &list);
+				if(
+					result < 0 ||
+					dbll_list_go(
+						&checked, 
+						&state, 
+						is_head
+							? DBLL_GO_HEAD
+							: DBLL_GO_TAIL
+					) < 0 ||
+
+					memcmp(&list, &checked, sizeof(list)) != 0
+				) {
+					dbll_state_unload(&state);
+					return TEST_FAIL_ERR;
+				}
+			}
+
+			// all the way back up, and no further
+			while(cursor.depth > 0) {
+				if(dbll_cursor_up(&cursor) < 0) {
+					dbll_state_unload(&state);
+					return TEST_FAIL_ERR;
+				}
+			}
+
+			if(cursor.ptr != root_ptr || dbll_cursor_up(&cursor) >= 0) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		}
+
+		dbll_data_slot_t slot = { 0 };
+		dbll_data_slot_t checked_slot = { 0 };
+		if(
+			dbll_cursor_data(&cursor, &slot) < 0 ||
+			dbll_data_slot_load(&checked_slot, &state, root.data_ptr) < 0 ||
+			slot.this_ptr != checked_slot.this_ptr ||
+			slot.next_ptr != checked_slot.next_ptr ||
+			slot.data_index != checked_slot.data_index ||
+
+			// leaves have no head to go to
+			dbll_cursor_head(&cursor) < 0 ||
+			dbll_cursor_data(&cursor, &slot) >= 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// only chains have data slots, the other kinds have no pointer
+		// to one so their data isn't read as one
+		dbll_list_t kinds[3] = { 0 };
+		uint8_t pattern[64] = { 0 };
+		memset(pattern, 0xab, sizeof(pattern));
+		for(int i = 0; i < ARRAY_SIZE(kinds); i++) {
+			dbll_ptr_t ptr = dbll_state_alloc(&state);
+			if(ptr == DBLL_NULL || dbll_list_load(&kinds[i], &state, ptr) < 0) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		}
+
+		if(
+			dbll_list_data_alloc_bytes(&kinds[0], &state, 4) < 0 ||
+			dbll_list_data_alloc_bytes(&kinds[1], &state, 64) < 0 ||
+			dbll_list_data_alloc_extent(&kinds[2], &state, 64) < 0 ||
+			dbll_list_data_write(&kinds[0], &state, 0, pattern, 4) < 0 ||
+			dbll_list_data_write(&kinds[1], &state, 0, pattern, 64) < 0 ||
+			dbll_list_data_write(&kinds[2], &state, 0, pattern, 64) < 0 ||
+			kinds[0].data_kind != DBLL_DATA_INLINE ||
+			kinds[1].data_kind != DBLL_DATA_CLASS ||
+			kinds[2].data_kind != DBLL_DATA_EXTENT
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		for(int i = 0; i < ARRAY_SIZE(kinds); i++) {
+			if(
+				dbll_cursor_load(
+					&cursor, 
+					&state, 
+					kinds[i].this_ptr, 
+					NULL, 
+					0
+				) < 0 ||
+
+				dbll_cursor_data(&cursor, &slot) >= 0 ||
+				dbll_list_load(&checked, &state, kinds[i].this_ptr) < 0
+			) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+
+			dbll_cursor_list(&cursor, &list);
+			if(memcmp(&list, &checked, sizeof(list)) != 0) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	// pools don't have a mapping to point into
+	if(
+		dbll_state_load_flags(
+			&state, 
+			"db/test-cursor.dbll", 
+			DBLL_OPEN_POOL
+		) < 0
+	) {
+		return TEST_FAIL_ERR;
+	}
+		if(dbll_cursor_load(&cursor, &state, 1, NULL, 0) >= 0) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+// makes a data slot chain of count blocks, the last one points back
+// to the loop_index-th one, or nowhere if loop_index is -1
+static dbll_ptr_t chain_make(
+	dbll_state_t *state, 
+	dbll_index_t count, 
+	dbll_index_t loop_index
+) {
+	dbll_ptr_t first_ptr = DBLL_NULL;
+	dbll_ptr_t prev_ptr = DBLL_NULL;
+	dbll_ptr_t loop_ptr = DBLL_NULL;
+	for(dbll_index_t i = 0; i < count; i++) {
+		dbll_ptr_t ptr = dbll_state_alloc(state);
+		if(
+			ptr == DBLL_NULL || (
+				prev_ptr != DBLL_NULL &&
+				dbll_ptr_index_copy(
+					state, 
+					ptr, 
+					dbll_ptr_to_index(state, prev_ptr)
+				) < 0
+			)
+		) {
+			return DBLL_NULL;
+		}
+
+		if(i == 0) {
+			first_ptr = ptr;
+		}
+
+		if(i == loop_index) {
+			loop_ptr = ptr;
+		}
+
+		prev_ptr = ptr;
+	}
+
+	if(
+		loop_ptr != DBLL_NULL &&
+		dbll_ptr_index_copy(
+			state, 
+			loop_ptr, 
+			dbll_ptr_to_index(state, prev_ptr)
+		) < 0
+	) {
+		return DBLL_NULL;
+	}
+
+	return first_ptr;
+}
+
+// freed blocks get used again before the file grows
+static int chain_freed(dbll_state_t *state, dbll_index_t count) {
+	dbll_ptr_t block_count = state->header.block_count;
+	for(dbll_index_t i = 0; i < count; i++) {
+		if(dbll_state_alloc(state) == DBLL_NULL) {
+			return 0;
+		}
+	}
+
+	return state->header.block_count == block_count;
+}
+
+int test_data_chain() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-data-chain.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_state_sync_policy(&state, DBLL_SYNC_NONE);
+
+		// long enough that walking it recursively runs out of stack
+		dbll_index_t long_count = 10000000;
+		dbll_data_slot_t slot = { 0 };
+		dbll_index_t size = 0;
+		dbll_ptr_t first_ptr = chain_make(&state, long_count, -1);
+		if(
+			first_ptr == DBLL_NULL ||
+			dbll_data_slot_load(&slot, &state, first_ptr) < 0 ||
+			dbll_data_slot_last(&slot, &state, &size) != 
+				first_ptr + long_count - 1 ||
+			size != long_count - 1 ||
+			dbll_data_slot_cut_end(&slot, &state, long_count / 2) < 0 ||
+			dbll_data_slot_last(&slot, &state, NULL) != 
+				first_ptr + long_count / 2 - 1 ||
+			dbll_data_slot_free(&slot, &state) < 0 ||
+			!chain_freed(&state, long_count)
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// 5 blocks and then a cycle of 7, the last block is the
+		// one that points back
+		size = 0;
+		first_ptr = chain_make(&state, 12, 5);
+		if(
+			first_ptr == DBLL_NULL ||
+			dbll_data_slot_load(&slot, &state, first_ptr) < 0 ||
+			dbll_data_slot_last(&slot, &state, &size) != first_ptr + 11 ||
+			size != 11 ||
+			dbll_data_slot_cut_end(&slot, &state, 3) < 0 ||
+			dbll_data_slot_last(&slot, &state, NULL) != first_ptr + 8 ||
+			dbll_data_slot_free(&slot, &state) < 0 ||
+			!chain_freed(&state, 12)
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// all the way around to the first block, which can't be cut
+		size = 0;
+		first_ptr = chain_make(&state, 4, 0);
+		if(
+			first_ptr == DBLL_NULL ||
+			dbll_data_slot_load(&slot, &state, first_ptr) < 0 ||
+			dbll_data_slot_last(&slot, &state, &size) != first_ptr + 3 ||
+			size != 3 ||
+			dbll_data_slot_cut_end(&slot, &state, 4) >= 0 ||
+			dbll_data_slot_free(&slot, &state) < 0 ||
+			!chain_freed(&state, 4)
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+// a version 0 file with 2 byte pointers and 3 byte sizes, made by hand
+// so the fields are known to be in the right place
+int test_codec() {
+	const uint8_t file_mem[] = {
+		'd', 'b', 'l', 'l', 2, 3, 
+		0, 0,
+
+		// root list, its head is block 2
+		0, 2, 0, 0, 0, 0, 0, 0, 0,
+
+		// block 2, tail is block 3 and it has a data size
+		0, 0, 0, 3, 0, 0, 1, 2, 3,
+		0, 0, 0, 0, 0, 0, 0, 0, 0
+	};
+
+	FILE *file = fopen("db/test-codec.dbll", "wb");
+	if(
+		file == NULL ||
+		fwrite(file_mem, sizeof(file_mem), 1, file) != 1 ||
+		fclose(file) == EOF
+	) {
+		return TEST_FAIL_ERR;
+	}
+
+	dbll_state_t state = { 0 };
+	if(dbll_state_load(&state, "db/test-codec.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_list_t list = { 0 };
+		if(
+			state.root_list.head_ptr != 2 ||
+			dbll_list_load(&list, &state, 2) < 0 ||
+			list.tail_ptr != 3 ||
+			list.data_size != 0x010203
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		list.head_ptr = 0x0405;
+		list.data_size = 0x060708;
+		if(dbll_list_write(&list, &state) < 0) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	uint8_t block_mem[9] = { 0 };
+	const uint8_t block_expected[] = { 4, 5, 0, 3, 0, 0, 6, 7, 8 };
+	file = fopen("db/test-codec.dbll", "rb");
+	if(
+		file == NULL ||
+		fseek(file, 8 + 9, SEEK_SET) < 0 ||
+		fread(block_mem, sizeof(block_mem), 1, file) != 1 ||
+		fclose(file) == EOF ||
+		memcmp(block_mem, block_expected, sizeof(block_mem)) != 0
+	) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_data_copy() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-data-copy.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_data_slot_t slot = { 0 };
+		if(
+			dbll_list_data_resize(&state.root_list, &state, 3) < 0 ||
+			dbll_data_slot_load(
+				&slot, 
+				&state, 
+				state.root_list.data_ptr
+			) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		int page_size = state.header.data_slot_size;
+		uint8_t mem[64] = { 0 };
+		uint8_t read_mem[64] = { 0 };
+		for(int i = 0; i < page_size * 3; i++) {
+			mem[i] = i + 1;
+		}
+
+		// all three pages, then just the second one starting right on
+		// its boundary. nothing past what's asked for gets touched
+		uint8_t page_mem[64] = { 0 };
+		memset(page_mem, 0xff, page_size);
+		read_mem[page_size] = 0xaa;
+		if(
+			dbll_data_slot_write_mem(
+				&slot, 
+				&state, 
+				0, 
+				mem, 
+				page_size * 3
+			) < 0 ||
+
+			dbll_data_slot_read_mem(
+				&slot, 
+				&state, 
+				0, 
+				read_mem, 
+				page_size
+			) < 0 ||
+
+			memcmp(read_mem, mem, page_size) != 0 ||
+			read_mem[page_size] != 0xaa ||
+			dbll_data_slot_write_mem(
+				&slot, 
+				&state, 
+				page_size, 
+				page_mem, 
+				page_size
+			) < 0 ||
+
+			dbll_data_slot_read_mem(
+				&slot, 
+				&state, 
+				0, 
+				read_mem, 
+				page_size * 3
+			) < 0 ||
+
+			memcmp(read_mem, mem, page_size) != 0 ||
+			memcmp(read_mem + page_size, page_mem, page_size) != 0 ||
+			memcmp(
+				read_mem + page_size * 2, 
+				mem + page_size * 2, 
+				page_size
+			) != 0 ||
+
+			// the last byte is fine, one past it isn't
+			dbll_data_slot_read_mem(
+				&slot, 
+				&state, 
+				page_size * 3 - 1, 
+				read_mem, 
+				1
+			) < 0 ||
+
+			read_mem[0] != mem[page_size * 3 - 1] ||
+			dbll_data_slot_read_mem(
+				&slot, 
+				&state, 
+				page_size * 2 + 1, 
+				read_mem, 
+				page_size
+			) >= 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_page_table() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-page-table.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_index_t page_count = 200;
+		dbll_data_slot_t slot = { 0 };
+		dbll_data_slot_t table_slot = { 0 };
+		dbll_page_table_t table = { 0 };
+		if(
+			dbll_list_data_resize(
+				&state.root_list, 
+				&state, 
+				page_count
+			) < 0 ||
+
+			dbll_data_slot_load(
+				&slot, 
+				&state, 
+				state.root_list.data_ptr
+			) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		table_slot = slot;
+		dbll_index_t size = page_count * state.header.data_slot_size;
+		uint8_t *mem = malloc(size);
+		if(
+			mem == NULL ||
+			dbll_page_table_load(&table, &table_slot) < 0
+		) {
+			free(mem);
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		for(dbll_index_t i = 0; i < size; i++) {
+			mem[i] = i * 7;
+		}
+
+		// only filled in as far as the last page asked for
+		uint8_t byte = 0;
+		if(
+			dbll_data_slot_write_mem(&table_slot, &state, 0, mem, size) < 0 ||
+			dbll_data_slot_read_mem(&table_slot, &state, 50, &byte, 1) < 0 ||
+			byte != mem[50] ||
+			table.count > 50 / state.header.data_slot_size + 1
+		) {
+			free(mem);
+			dbll_page_table_unload(&table);
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		for(dbll_index_t i = size - 1; i >= 0; i -= 97) {
+			uint8_t table_byte = 0;
+			if(
+				dbll_data_slot_read_mem(&slot, &state, i, &byte, 1) < 0 ||
+				dbll_data_slot_read_mem(
+					&table_slot, 
+					&state, 
+					i, 
+					&table_byte, 
+					1
+				) < 0 ||
+
+				byte != mem[i] ||
+				table_byte != mem[i] ||
+				dbll_data_slot_page(&slot, &state, i) != 
+					dbll_data_slot_page(&table_slot, &state, i)
+			) {
+				free(mem);
+				dbll_page_table_unload(&table);
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		}
+
+		// cutting the chain makes the table start over, so the
+		// pages that are gone aren't found in it anymore
+		if(
+			dbll_data_slot_cut_end(&slot, &state, page_count / 2) < 0 ||
+			dbll_data_slot_read_mem(
+				&table_slot, 
+				&state, 
+				size - 1, 
+				&byte, 
+				1
+			) >= 0 ||
+
+			dbll_data_slot_read_mem(
+				&table_slot, 
+				&state, 
+				size / 2 - 1, 
+				&byte, 
+				1
+			) < 0 ||
+
+			byte != mem[size / 2 - 1]
+		) {
+			free(mem);
+			dbll_page_table_unload(&table);
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		free(mem);
+		dbll_page_table_unload(&table);
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_data_append() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-data-append.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_list_t list = { 0 };
+		list.this_ptr = dbll_state_alloc(&state);
+		if(
+			list.this_ptr == DBLL_NULL ||
+			dbll_list_write(&list, &state) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// pieces of every size up to a few blocks, so they start and
+		// end everywhere in a block. half way through the list is
+		// loaded again, so the last block has to be found again
+		uint8_t mem[4096] = { 0 };
+		dbll_index_t size = 0;
+		for(int i = 0; size + i <= sizeof(mem); i = (i + 1) % 40) {
+			for(int j = 0; j < i; j++) {
+				mem[size + j] = size + j;
+			}
+
+			if(
+				dbll_list_data_append(&list, &state, mem + size, i) < 0 ||
+				(
+					size > sizeof(mem) / 2 &&
+					size - i <= sizeof(mem) / 2 &&
+					dbll_list_load(&list, &state, list.this_ptr) < 0
+				)
+			) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+
+			size += i;
+			if(list.data_size != size) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		}
+
+		uint8_t read_mem[4096] = { 0 };
+		dbll_data_slot_t slot = { 0 };
+		dbll_index_t count = 0;
+		if(
+			dbll_data_slot_load(&slot, &state, list.data_ptr) < 0 ||
+			dbll_data_slot_read_mem(&slot, &state, 0, read_mem, size) < 0 ||
+			memcmp(read_mem, mem, size) != 0 ||
+			dbll_data_slot_last(&slot, &state, &count) != 
+				list.data_tail_ptr ||
+			count + 1 != 
+				(size + state.header.data_slot_size - 1) / 
+				state.header.data_slot_size
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// growing hands the list whole blocks, appending goes after them
+		uint8_t byte = 0xaa;
+		dbll_index_t grown_size = (
+			(count + 2) * 
+			state.header.data_slot_size
+		);
+
+		if(
+			dbll_list_data_resize(&list, &state, 1) < 0 ||
+			list.data_size != grown_size ||
+			dbll_list_data_append(&list, &state, &byte, 1) < 0 ||
+			list.data_size != grown_size + 1 ||
+			dbll_data_slot_read_mem(
+				&slot, 
+				&state, 
+				grown_size, 
+				read_mem, 
+				1
+			) < 0 ||
+
+			read_mem[0] != byte ||
+			dbll_list_data_resize(&list, &state, -(count + 3)) < 0 ||
+			list.data_ptr != DBLL_NULL ||
+			list.data_size != 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_data_iov() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-data-iov.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		uint8_t mem[120] = { 0 };
+		for(int i = 0; i < sizeof(mem); i++) {
+			mem[i] = i + 1;
+		}
+
+		dbll_data_slot_t slot = { 0 };
+		if(
+			dbll_list_data_append(
+				&state.root_list, 
+				&state, 
+				mem, 
+				sizeof(mem)
+			) < 0 ||
+
+			dbll_data_slot_load(
+				&slot, 
+				&state, 
+				state.root_list.data_ptr
+			) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// starting part way into a block and ending part way into another
+		struct iovec iovs[16] = { 0 };
+		int page_size = state.header.data_slot_size;
+		int count = dbll_data_slot_iov(&slot, &state, 5, 100, iovs, 16);
+		if(count != (5 + 100 + page_size - 1) / page_size) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		dbll_index_t offset = 5;
+		for(int i = 0; i < count; i++) {
+			if(memcmp(iovs[i].iov_base, mem + offset, iovs[i].iov_len) != 0) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+
+			offset += iovs[i].iov_len;
+		}
+
+		// not enough spans stops early
+		if(
+			offset != 105 ||
+			dbll_data_slot_iov(&slot, &state, 0, 100, iovs, 2) != 2 ||
+			iovs[0].iov_len + iovs[1].iov_len != page_size * 2 ||
+			dbll_data_slot_iov(&slot, &state, 0, 121, iovs, 16) >= 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	// pool pages don't stay put
+	if(
+		dbll_state_load_flags(
+			&state, 
+			"db/test-data-iov.dbll", 
+			DBLL_OPEN_POOL
+		) < 0
+	) {
+		return TEST_FAIL_ERR;
+	}
+		struct iovec iov = { 0 };
+		if(
+			dbll_data_slot_load(
+				&slot, 
+				&state, 
+				state.root_list.data_ptr
+			) < 0 ||
+
+			dbll_data_slot_iov(&slot, &state, 0, 1, &iov, 1) >= 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_data_extent() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-data-extent.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		// two empty blocks at the end get used for the start of the run
+		dbll_list_t list = { 0 };
+		list.this_ptr = dbll_state_alloc(&state);
+		state.root_list.head_ptr = list.this_ptr;
+		dbll_ptr_t first_free = dbll_state_alloc(&state);
+		dbll_ptr_t second_free = dbll_state_alloc(&state);
+		if(
+			list.this_ptr == DBLL_NULL ||
+			dbll_list_write(&list, &state) < 0 ||
+			dbll_list_write(&state.root_list, &state) < 0 ||
+			dbll_state_mark_free(&state, second_free) < 0 ||
+			dbll_state_mark_free(&state, first_free) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		int block_size = state.header.block_size;
+		uint8_t mem[1000] = { 0 };
+		for(int i = 0; i < sizeof(mem); i++) {
+			mem[i] = i * 7;
+		}
+
+		dbll_ptr_t block_count = state.header.block_count;
+		dbll_index_t run_count = (sizeof(mem) + block_size - 1) / block_size;
+		if(
+			dbll_list_data_alloc_extent(&list, &state, sizeof(mem)) < 0 ||
+			list.data_ptr != first_free ||
+			list.data_kind != DBLL_DATA_EXTENT ||
+			state.header.block_count != block_count + run_count - 2 ||
+			state.last_empty.this_ptr != DBLL_NULL ||
+			dbll_list_data_write(&list, &state, 0, mem, sizeof(mem)) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// the data really is in a row, and the kind comes back
+		// when the list is loaded
+		uint8_t read_mem[1000] = { 0 };
+		struct iovec iov = { 0 };
+		dbll_index_t index = dbll_ptr_to_index(&state, list.data_ptr);
+		if(
+			dbll_list_load(&list, &state, list.this_ptr) < 0 ||
+			list.data_kind != DBLL_DATA_EXTENT ||
+			list.data_size != sizeof(mem) ||
+			dbll_list_data_read(&list, &state, 0, read_mem, 1000) < 0 ||
+			memcmp(read_mem, mem, sizeof(mem)) != 0 ||
+			memcmp(state.file.mem + index, mem, sizeof(mem)) != 0 ||
+			dbll_list_data_iov(&list, &state, 10, 900, &iov, 1) != 1 ||
+			iov.iov_len != 900 ||
+			memcmp(iov.iov_base, mem + 10, 900) != 0 ||
+			dbll_list_data_read(&list, &state, 1, read_mem, 1000) >= 0 ||
+			dbll_list_data_append(&list, &state, mem, 1) >= 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// a block of user data that starts with its own pointer
+		// isn't an empty slot, trimming leaves it alone
+		dbll_ptr_t last_ptr = list.data_ptr + run_count - 1;
+		block_count = state.header.block_count;
+		if(
+			last_ptr != block_count ||
+			dbll_ptr_index_copy(
+				&state, 
+				last_ptr, 
+				dbll_ptr_to_index(&state, last_ptr)
+			) < 0 ||
+
+			dbll_empty_slot_valid_ptr(&state, last_ptr) ||
+			dbll_state_trim(&state) < 0 ||
+			state.header.block_count != block_count
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// the run can't be moved into bigger blocks or compacted,
+		// swapping the byte order leaves the data alone
+		if(
+			dbll_state_compact(&state) >= 0 ||
+			state.header.block_count != block_count ||
+			dbll_state_convert(&state, DBLL_FORMAT_ALIGNED) >= 0 ||
+			dbll_state_convert(&state, DBLL_FORMAT_NATIVE) < 0 ||
+			dbll_list_load(&list, &state, list.this_ptr) < 0 ||
+			list.data_kind != DBLL_DATA_EXTENT ||
+			list.data_size != sizeof(mem) ||
+			dbll_list_data_read(&list, &state, 0, read_mem, 10) < 0 ||
+			memcmp(read_mem, mem, 10) != 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// shrinking gives back blocks off the end, all of them
+		// leaves the list without data
+		if(
+			dbll_list_data_resize(&list, &state, 1) >= 0 ||
+			dbll_list_data_resize(&list, &state, -1) < 0 ||
+			list.data_size != (run_count - 1) * block_size ||
+			state.last_empty.this_ptr != last_ptr ||
+			dbll_list_data_resize(&list, &state, -(run_count - 1)) < 0 ||
+			list.data_ptr != DBLL_NULL ||
+			list.data_kind != DBLL_DATA_CHAIN ||
+			dbll_state_trim(&state) < 0 ||
+			state.header.block_count != list.this_ptr
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// a run the file can't grow for leaves the empty blocks at
+		// the end where they were, a file size limit stops the grow
+		first_free = dbll_state_alloc(&state);
+		second_free = dbll_state_alloc(&state);
+		block_count = state.header.block_count;
+		struct rlimit limit = { 0 };
+		struct rlimit old_limit = { 0 };
+		if(
+			second_free != first_free + 1 ||
+			dbll_state_mark_free(&state, first_free) < 0 ||
+			dbll_state_mark_free(&state, second_free) < 0 ||
+			getrlimit(RLIMIT_FSIZE, &old_limit) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		limit = old_limit;
+		limit.rlim_cur = state.file.size;
+		signal(SIGXFSZ, SIG_IGN);
+		if(setrlimit(RLIMIT_FSIZE, &limit) < 0) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		dbll_ptr_t run_ptr = dbll_state_alloc_run(&state, 100000);
+		if(setrlimit(RLIMIT_FSIZE, &old_limit) < 0) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		if(
+			run_ptr != DBLL_NULL ||
+			state.last_empty.this_ptr != second_free ||
+			state.header.block_count != block_count ||
+			dbll_state_alloc_run(&state, 2) != first_free ||
+			state.header.block_count != block_count
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_data_class() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-data-class.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		// 4 lists under the root, each one a size that goes somewhere
+		// else: the smallest class, the next one, the biggest and
+		// past the biggest
+		int block_size = state.header.block_size;
+		dbll_index_t sizes[] = { 10, block_size + 1, block_size << 8, 5000 };
+		dbll_data_e kinds[] = { 
+			DBLL_DATA_CLASS, 
+			DBLL_DATA_CLASS, 
+			DBLL_DATA_CLASS, 
+			DBLL_DATA_EXTENT 
+		};
+
+		dbll_list_t lists[4] = { 0 };
+		uint8_t mem[5000] = { 0 };
+		dbll_ptr_t parent_ptr = 1;
+		for(int i = 0; i < 4; i++) {
+			dbll_list_t parent = { 0 };
+			lists[i].this_ptr = dbll_state_alloc(&state);
+			for(int j = 0; j < sizes[i]; j++) {
+				mem[j] = i + j;
+			}
+
+			if(
+				state.header.version != 3 ||
+				dbll_list_load(&parent, &state, parent_ptr) < 0
+			) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+
+			parent.head_ptr = lists[i].this_ptr;
+			if(
+				dbll_list_write(&parent, &state) < 0 ||
+				dbll_list_write(&lists[i], &state) < 0 ||
+				dbll_list_data_alloc_bytes(&lists[i], &state, sizes[i]) < 0 ||
+				lists[i].data_kind != kinds[i] ||
+				dbll_list_data_write(&lists[i], &state, 0, mem, sizes[i]) < 0
+			) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+
+			parent_ptr = lists[i].this_ptr;
+		}
+
+		// slots of a class come out of the same slab one after another,
+		// and a freed one is the next one handed out
+		dbll_list_t list = { 0 };
+		list.this_ptr = dbll_state_alloc(&state);
+		dbll_ptr_t slot_ptr = lists[0].data_ptr;
+		if(
+			dbll_list_write(&list, &state) < 0 ||
+			dbll_list_data_alloc_bytes(&list, &state, 10) < 0 ||
+			list.data_ptr != slot_ptr + 1 ||
+			dbll_list_data_resize(&list, &state, -2) >= 0 ||
+			dbll_list_data_resize(&list, &state, -1) < 0 ||
+			list.data_ptr != DBLL_NULL ||
+			dbll_list_data_alloc_bytes(&list, &state, 10) < 0 ||
+			list.data_ptr != slot_ptr + 1 ||
+			dbll_list_data_resize(&list, &state, -1) < 0 ||
+			dbll_list_data_append(&lists[0], &state, mem, 1) >= 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// a slot that was used comes back zeroed
+		uint8_t byte = 0xff;
+		if(
+			dbll_list_data_alloc_bytes(&list, &state, 10) < 0 ||
+			dbll_list_data_write(&list, &state, 0, &byte, 1) < 0 ||
+			dbll_list_data_resize(&list, &state, -1) < 0 ||
+			dbll_list_data_alloc_bytes(&list, &state, 10) < 0 ||
+			dbll_list_data_read(&list, &state, 0, &byte, 1) < 0 ||
+			byte != 0 ||
+			dbll_list_data_resize(&list, &state, -1) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// dbll_list_data_alloc still counts blocks, and makes a chain
+		if(
+			dbll_list_data_alloc(&list, &state, 2) < 0 ||
+			list.data_kind != DBLL_DATA_CHAIN ||
+			list.data_size != 2 * state.header.data_slot_size ||
+			dbll_list_data_resize(&list, &state, -2) < 0 ||
+			list.data_ptr != DBLL_NULL
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// swapping the byte order swaps the free lists too, the slots
+		// can't be moved into bigger blocks
+		if(
+			dbll_state_convert(&state, DBLL_FORMAT_ALIGNED) >= 0 ||
+			dbll_state_convert(&state, DBLL_FORMAT_NATIVE) < 0 ||
+			dbll_list_data_alloc_bytes(&list, &state, 10) < 0 ||
+			list.data_ptr != slot_ptr + 1 ||
+			dbll_list_data_resize(&list, &state, -1) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	// the class table comes back with the header
+	if(dbll_state_load(&state, "db/test-data-class.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_ptr_t ptr = 1;
+		for(int i = 0; i < 4; i++) {
+			uint8_t read_mem[5000] = { 0 };
+			for(int j = 0; j < sizes[i]; j++) {
+				mem[j] = i + j;
+			}
+
+			dbll_list_t parent = { 0 };
+			if(
+				dbll_list_load(&parent, &state, ptr) < 0 ||
+				dbll_list_load(&lists[i], &state, parent.head_ptr) < 0 ||
+				lists[i].data_kind != kinds[i] ||
+				lists[i].data_size != sizes[i] ||
+				dbll_list_data_read(&lists[i], &state, 0, read_mem, sizes[i]) < 0 ||
+				memcmp(read_mem, mem, sizes[i]) != 0
+			) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+
+			ptr = parent.head_ptr;
+		}
+
+		if(
+			dbll_list_data_alloc_bytes(&list, &state, 10) < 0 ||
+			list.data_ptr != slot_ptr + 1
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_data_inline() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-data-inline.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		// the biggest value that fits takes no blocks
+		int inline_max = state.header.ptr_size + state.header.data_size - 1;
+		uint8_t mem[] = "tag:1234";
+		dbll_list_t list = { 0 };
+		list.this_ptr = dbll_state_alloc(&state);
+		state.root_list.head_ptr = list.this_ptr;
+		dbll_ptr_t block_count = state.header.block_count;
+		if(
+			inline_max != 7 ||
+			dbll_list_write(&state.root_list, &state) < 0 ||
+			dbll_list_write(&list, &state) < 0 ||
+			dbll_list_data_alloc_bytes(&list, &state, inline_max) < 0 ||
+			list.data_kind != DBLL_DATA_INLINE ||
+			list.data_ptr != DBLL_NULL ||
+			dbll_list_data_write(&list, &state, 0, mem, inline_max) < 0 ||
+			state.header.block_count != block_count
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// it comes back from the file, and through a cursor
+		dbll_cursor_t cursor = { 0 };
+		dbll_list_t cursor_list = { 0 };
+		uint8_t read_mem[16] = { 0 };
+		struct iovec iov = { 0 };
+		if(
+			dbll_list_load(&list, &state, list.this_ptr) < 0 ||
+			list.data_kind != DBLL_DATA_INLINE ||
+			list.data_size != inline_max ||
+			dbll_list_data_read(&list, &state, 0, read_mem, inline_max) < 0 ||
+			memcmp(read_mem, mem, inline_max) != 0 ||
+			dbll_list_data_iov(&list, &state, 4, 3, &iov, 1) != 1 ||
+			memcmp(iov.iov_base, mem + 4, 3) != 0 ||
+			dbll_cursor_load(&cursor, &state, 1, NULL, 0) < 0 ||
+			dbll_cursor_head(&cursor) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		dbll_cursor_list(&cursor, &cursor_list);
+		if(
+			cursor_list.data_kind != DBLL_DATA_INLINE ||
+			cursor_list.data_size != inline_max ||
+			memcmp(cursor_list.data_inline, mem, inline_max) != 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// the value is the fields, so it's the same in either byte
+		// order, and the blocks can move with it
+		if(
+			dbll_state_convert(&state, DBLL_FORMAT_NATIVE) < 0 ||
+			dbll_state_convert(&state, DBLL_FORMAT_ALIGNED) < 0 ||
+			dbll_list_load(&list, &state, list.this_ptr) < 0 ||
+			list.data_kind != DBLL_DATA_INLINE ||
+			memcmp(list.data_inline, mem, inline_max) != 0 ||
+			dbll_state_convert(&state, DBLL_FORMAT_DEFAULT) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// appending past what fits moves it into a chain
+		if(
+			dbll_list_data_append(&list, &state, mem + inline_max, 1) < 0 ||
+			list.data_kind != DBLL_DATA_CHAIN ||
+			list.data_size != inline_max + 1 ||
+			dbll_list_data_read(&list, &state, 0, read_mem, inline_max + 1) < 0 ||
+			memcmp(read_mem, mem, inline_max + 1) != 0 ||
+			dbll_list_data_resize(&list, &state, -1) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// one byte more than fits is a class slot, taking any blocks
+		// away from an inline value drops it
+		if(
+			dbll_list_data_alloc_bytes(&list, &state, inline_max + 1) < 0 ||
+			list.data_kind != DBLL_DATA_CLASS ||
+			dbll_list_data_resize(&list, &state, -1) < 0 ||
+			dbll_list_data_alloc_bytes(&list, &state, 1) < 0 ||
+			dbll_list_data_resize(&list, &state, 1) >= 0 ||
+			dbll_list_data_resize(&list, &state, -1) < 0 ||
+			list.data_size != 0 ||
+			list.data_kind != DBLL_DATA_CHAIN
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+int test_alloc_n() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-alloc-n.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		// a contiguous batch is a run past the blocks there are
+		dbll_ptr_t ptrs[8] = { 0 };
+		dbll_ptr_t block_count = state.header.block_count;
+		if(
+			dbll_state_alloc_n(&state, 6, ptrs, DBLL_ALLOC_CONTIGUOUS) < 0 ||
+			state.header.block_count != block_count + 6 ||
+			dbll_state_alloc_n(&state, 1, NULL, 0) >= 0 ||
+			dbll_state_alloc_n(&state, 1, ptrs, 1 << 5) >= 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		for(int i = 0; i < 6; i++) {
+			if(ptrs[i] != block_count + 1 + i) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		}
+
+		// empty slots come first, the last one freed first, then
+		// new blocks. freed blocks come back zeroed
+		dbll_ptr_t freed[3] = { ptrs[1], ptrs[4], ptrs[2] };
+		dbll_ptr_t value = 0;
+		for(int i = 0; i < 3; i++) {
+			if(dbll_state_mark_free(&state, freed[i]) < 0) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		}
+
+		if(
+			dbll_state_alloc_n(&state, 2, ptrs, 0) < 0 ||
+			ptrs[0] != freed[2] ||
+			ptrs[1] != freed[1] ||
+			state.last_empty.this_ptr != freed[0] ||
+			state.last_empty.next_ptr != DBLL_NULL ||
+			!dbll_empty_slot_valid_ptr(&state, freed[0]) ||
+			dbll_index_ptr_copy(
+				&state, 
+				dbll_ptr_to_index(&state, ptrs[0]), 
+				&value
+			) < 0 ||
+
+			value != DBLL_NULL
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		block_count = state.header.block_count;
+		if(
+			dbll_state_alloc_n(&state, 3, ptrs, 0) < 0 ||
+			ptrs[0] != freed[0] ||
+			ptrs[1] != block_count + 1 ||
+			ptrs[2] != block_count + 2 ||
+			state.header.block_count != block_count + 2 ||
+			state.last_empty.this_ptr != DBLL_NULL ||
+			state.header.first_empty_ptr != DBLL_NULL
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// chains are made out of batches, longer than one too
+		dbll_data_slot_t slot = { 0 };
+		dbll_index_t count = 0;
+		if(
+			dbll_data_slot_load(&slot, &state, ptrs[2]) < 0 ||
+			dbll_data_slot_alloc(&slot, &state, DBLL_ALLOC_BATCH + 10) < 0 ||
+			dbll_data_slot_last(&slot, &state, &count) == DBLL_NULL ||
+			count != DBLL_ALLOC_BATCH + 10
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+// a version 0 file like the ones from before there were versions, the
+// root list has a chain of 3 blocks with "hello, there!" in it. its data
+// size is how many blocks there are
+static int v0_file_make(const char *path) {
+	const uint8_t file_mem[] = {
+		'd', 'b', 'l', 'l', 4, 4, 
+		0, 0, 0, 0,
+
+		// root list, its data is block 2 on
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 3,
+
+		// the chain, 12 bytes of data after each next pointer
+		0, 0, 0, 3, 
+		'h', 'e', 'l', 'l', 'o', ',', ' ', 't', 'h', 'e', 'r', 'e',
+		0, 0, 0, 4, 
+		'!', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0, 0, 0, 
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+	};
+
+	FILE *file = fopen(path, "wb");
+	if(
+		file == NULL ||
+		fwrite(file_mem, sizeof(file_mem), 1, file) != 1 ||
+		fclose(file) == EOF
+	) {
+		return TEST_FAIL;
+	}
+
+	return TEST_PASS;
+}
+
+// version 0 files keep a block count in data_size, so all of every
+// block is data and appending starts a new block
+int test_data_v0() {
+	if(v0_file_make("db/test-data-v0.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	dbll_state_t state = { 0 };
+	if(dbll_state_load(&state, "db/test-data-v0.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		char mem[48] = { 0 };
+		dbll_list_t *list = &state.root_list;
+		if(
+			list->data_size != 3 ||
+			dbll_list_data_read(list, &state, 0, (uint8_t *)(mem), 14) < 0 ||
+			strcmp(mem, "hello, there!") != 0 ||
+			dbll_list_data_read(list, &state, 0, (uint8_t *)(mem), 36) < 0 ||
+			dbll_list_data_read(list, &state, 0, (uint8_t *)(mem), 37) >= 0 ||
+			dbll_list_data_append(list, &state, (uint8_t *)("XY"), 2) < 0 ||
+			list->data_size != 4
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	if(dbll_state_load(&state, "db/test-data-v0.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		char expected[48] = "hello, there!";
+		memcpy(expected + 36, "XY", 2);
+		if(
+			state.root_list.data_size != 4 ||
+			dbll_list_data_read(
+				&state.root_list, 
+				&state, 
+				0, 
+				(uint8_t *)(mem), 
+				sizeof(mem)
+			) < 0 ||
+
+			memcmp(mem, expected, sizeof(mem)) != 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+// converting upgrades the header, the data size becomes bytes and
+// the data has to read the same, before and after reopening
+int test_convert_v0() {
+	if(v0_file_make("db/test-convert-v0.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	dbll_state_t state = { 0 };
+	if(dbll_state_load(&state, "db/test-convert-v0.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		char mem[48] = { 0 };
+		dbll_list_t *list = &state.root_list;
+		if(
+			dbll_state_convert(&state, DBLL_FORMAT_NATIVE) < 0 ||
+			state.header.version != DBLL_HEADER_VERSION ||
+			list->data_size != 36 ||
+			list->data_kind != DBLL_DATA_CHAIN ||
+			dbll_list_data_read(list, &state, 0, (uint8_t *)(mem), 36) < 0 ||
+			strcmp(mem, "hello, there!") != 0 ||
+			dbll_list_data_append(list, &state, (uint8_t *)("XY"), 2) < 0 ||
+			list->data_size != 38
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	if(dbll_state_load(&state, "db/test-convert-v0.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		char expected[48] = "hello, there!";
+		memcpy(expected + 36, "XY", 2);
+		if(
+			state.header.version != DBLL_HEADER_VERSION ||
+			state.header.flags != DBLL_FORMAT_NATIVE ||
+			state.root_list.data_size != 38 ||
+			dbll_list_data_read(
+				&state.root_list, 
+				&state, 
+				0, 
+				(uint8_t *)(mem), 
+				38
+			) < 0 ||
+
+			memcmp(mem, expected, 38) != 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
+// a chain that can't grow all the way is left the way it was, and so
+// are the empty slots. a file size limit keeps the file from growing
+// once the first batch has been linked in
+int test_alloc_unwind() {
+	dbll_state_t state = { 0 };
+	if(dbll_state_make_replace(&state, "db/test-alloc-unwind.dbll") < 0) {
+		return TEST_FAIL_ERR;
+	}
+		dbll_ptr_t ptrs[1500] = { 0 };
+		dbll_state_sync_policy(&state, DBLL_SYNC_NONE);
+		if(dbll_state_alloc_n(&state, ARRAY_SIZE(ptrs), ptrs, 0) < 0) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		for(int i = 0; i < ARRAY_SIZE(ptrs); i++) {
+			if(dbll_state_mark_free(&state, ptrs[i]) < 0) {
+				dbll_state_unload(&state);
+				return TEST_FAIL_ERR;
+			}
+		}
+
+		dbll_data_slot_t slot = { 0 };
+		dbll_ptr_t head_ptr = dbll_state_alloc(&state);
+		dbll_ptr_t block_count = state.header.block_count;
+		struct rlimit limit = { 0 };
+		struct rlimit old_limit = { 0 };
+		if(
+			head_ptr == DBLL_NULL ||
+			dbll_data_slot_load(&slot, &state, head_ptr) < 0 ||
+			getrlimit(RLIMIT_FSIZE, &old_limit) < 0
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		limit = old_limit;
+		limit.rlim_cur = state.file.size;
+		signal(SIGXFSZ, SIG_IGN);
+		if(setrlimit(RLIMIT_FSIZE, &limit) < 0) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		int result = dbll_data_slot_alloc(&slot, &state, 10000);
+		if(setrlimit(RLIMIT_FSIZE, &old_limit) < 0) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+
+		// every empty slot is still there, so taking all of them
+		// doesn't grow the file
+		if(
+			result >= 0 ||
+			slot.next_ptr != DBLL_NULL ||
+			dbll_data_slot_load(&slot, &state, head_ptr) < 0 ||
+			slot.next_ptr != DBLL_NULL ||
+			state.header.block_count != block_count ||
+			dbll_state_alloc_n(&state, ARRAY_SIZE(ptrs) - 1, ptrs, 0) < 0 ||
+			state.header.block_count != block_count ||
+			dbll_state_alloc(&state) != block_count + 1
+		) {
+			dbll_state_unload(&state);
+			return TEST_FAIL_ERR;
+		}
+	if(dbll_state_unload(&state) < 0) {
+		return TEST_FAIL_ERR;
+	}
+
+	return TEST_PASS;
+}
+
 // check the test-data-write.dbll file to see if it worked
 // manually
 int test_data_write() {
@@ -116,7 +2536,34 @@ const test_func_t dbll_test_funcs[] = {
 	TEST_FUNC(test_make_replace),
 	TEST_FUNC(test_alloc),
 	TEST_FUNC(test_mark_free),
-	TEST_FUNC(test_data_write)
+	TEST_FUNC(test_free_reload),
+	TEST_FUNC(test_alloc_grow),
+	TEST_FUNC(test_stable_map),
+	TEST_FUNC(test_sync_policy),
+	TEST_FUNC(test_dirty_pages),
+	TEST_FUNC(test_large_file),
+	TEST_FUNC(test_readonly),
+	TEST_FUNC(test_prefetch),
+	TEST_FUNC(test_data_write),
+	TEST_FUNC(test_pool),
+	TEST_FUNC(test_fetch),
+	TEST_FUNC(test_convert),
+	TEST_FUNC(test_codec),
+	TEST_FUNC(test_aligned),
+	TEST_FUNC(test_unchecked),
+	TEST_FUNC(test_cursor),
+	TEST_FUNC(test_data_chain),
+	TEST_FUNC(test_data_copy),
+	TEST_FUNC(test_page_table),
+	TEST_FUNC(test_data_append),
+	TEST_FUNC(test_data_iov),
+	TEST_FUNC(test_data_extent),
+	TEST_FUNC(test_data_class),
+	TEST_FUNC(test_data_inline),
+	TEST_FUNC(test_alloc_n),
+	TEST_FUNC(test_data_v0),
+	TEST_FUNC(test_convert_v0),
+	TEST_FUNC(test_alloc_unwind)
 };
 
 int main() {